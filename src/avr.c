@@ -333,18 +333,43 @@ int avr_mem_hiaddr(const AVRMEM *mem) {
     return mem->size;
 
   // Return smallest even memory size outsize beyond which only 0xff reside
-  for(int i = mem->size - 1; i >= 0; i--) {
-    if(mem->buf[i] != 0xff) {
-      ret = i + 1 + !(i & 1);   // Ensure even return
-      goto ok;
-    }
+  int i = mem->size;
+
+  for(uint64_t w; i >= 8; i -= 8) {     // Skip trailing 0xff eight bytes at a time
+    memcpy(&w, mem->buf + i - 8, sizeof w);
+    if(w != ~(uint64_t) 0)
+      break;
   }
+  while(i > 0 && mem->buf[i - 1] == 0xff)
+    i--;
+  ret = i + (i & 1);            // Ensure even return
 
-ok:
   pmsg_trace("%s(%s) returns %s\n", __func__, mem->desc, str_ccaddress(ret, mem->size));
   return ret;
 }
 
+/*
+ * Return the first address in [from, to) of mem that is tagged TAG_ALLOCATED
+ * or to if there is none. Runs of unallocated bytes, typically most of a
+ * large flash memory, are skipped eight at a time.
+ */
+int avr_mem_next_allocated(const AVRMEM *mem, int from, int to) {
+  const unsigned char *tags = mem->tags;
+
+  if(to > mem->size)
+    to = mem->size;
+  for(uint64_t w; from + 8 <= to; from += 8) {
+    memcpy(&w, tags + from, sizeof w);
+    if(w & 0x0101010101010101ULL*TAG_ALLOCATED)
+      break;
+  }
+  for(; from < to; from++)
+    if(tags[from] & TAG_ALLOCATED)
+      return from;
+
+  return to;
+}
+
 /*
  * Read the entirety of the specified memory into the corresponding buffer of
  * the avrpart pointed to by p. If v is non-NULL, verify against v's memory
@@ -363,6 +388,79 @@ int avr_read(const PROGRAMMER *pgm, const AVRPART *p, const char *memstr, const
   return avr_read_mem(pgm, p, mem, v);
 }
 
+/*
+ * Return an mmt_malloc()ed ascending list of the addresses of the pgsize
+ * pages in [0, size) that hold at least one byte of tm tagged TAG_ALLOCATED
+ * and set *np to their number; list all pages if tm is NULL. Scanning jumps
+ * from one allocated byte to the start of the next page, so large empty
+ * regions of sparse images cost little, and callers know the number of
+ * pages for progress reports before the first transfer.
+ */
+static unsigned int *avr_pages_in_use(const AVRMEM *tm, int size, int pgsize, unsigned int *np) {
+  int end = tm && tm->size < size? tm->size: size;
+  unsigned int n = 0, *ret = mmt_malloc(((size + pgsize - 1)/pgsize + 1)*sizeof *ret);
+
+  for(int a = tm? avr_mem_next_allocated(tm, 0, end): 0; a < end;) {
+    int pageaddr = a/pgsize*pgsize;
+
+    ret[n++] = pageaddr;
+    a = tm? avr_mem_next_allocated(tm, pageaddr + pgsize, end): pageaddr + pgsize;
+  }
+  *np = n;
+
+  return ret;
+}
+
+/*
+ * Read the npages pages of mem listed in pages[] keeping as many page requests in flight as the
+ * programmer accepts: pgm->paged_load_async() queues a request and returns
+ * LIBAVRDUDE_SOFTFAIL when its window is full, at which point the oldest
+ * request is retired with pgm->paged_load_collect(). Requests are collected
+ * in the order they were issued. On error the programmer is expected to have
+ * discarded all outstanding requests.
+ *
+ * Returns LIBAVRDUDE_SUCCESS, LIBAVRDUDE_NOTSUPPORTED if the programmer
+ * declined the first request (caller should read page by page instead) or
+ * another negative value on failure.
+ */
+static int avr_paged_load_pipelined(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
+  const unsigned int *pages, unsigned int npages) {
+
+  unsigned int pgsize = mem->page_size, head = 0, tail = 0;     // Pages [head, tail) are in flight
+  int rc = LIBAVRDUDE_SUCCESS;
+
+  while(head < npages) {
+    // Fill the window
+    for(; tail < npages; tail++) {
+      rc = pgm->paged_load_async(pgm, p, mem, pgsize, pages[tail], pgsize);
+      if(rc == LIBAVRDUDE_SOFTFAIL && head < tail)      // Window full
+        break;
+      if(rc < 0) {
+        if(rc == LIBAVRDUDE_NOTSUPPORTED && tail)       // Only valid for first request
+          rc = LIBAVRDUDE_GENERAL_FAILURE;
+        goto done;
+      }
+    }
+    if(head == tail) {          // Nothing in flight and nothing could be queued
+      rc = LIBAVRDUDE_GENERAL_FAILURE;
+      goto done;
+    }
+
+    rc = pgm->paged_load_collect(pgm, p, mem, pgsize, pages[head], pgsize);
+    if(rc < 0)
+      goto done;
+    head++;
+    report_progress(head, npages, NULL);
+  }
+  rc = LIBAVRDUDE_SUCCESS;
+
+done:
+  if(rc < 0 && rc != LIBAVRDUDE_NOTSUPPORTED)
+    pmsg_debug("%s(): pipelined read of %s failed after %u of %u pages\n", __func__,
+      mem->desc, head, npages);
+  return rc;
+}
+
 int avr_read_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, const AVRPART *v) {
   unsigned long i, lastaddr;
   unsigned char cmd[4];
@@ -380,8 +478,16 @@ int avr_read_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, con
   led_clr(pgm, LED_ERR);
   led_set(pgm, LED_PGM);
 
-  // Start with all 0xff
-  memset(mem->buf, 0xff, mem->size);
+  // Start with all 0xff; when verifying only bytes of the input file are read
+  if(!vmem || vmem->size != mem->size)
+    memset(mem->buf, 0xff, mem->size);
+  else
+    for(int a = 0, b; a < mem->size; a = b) {
+      b = avr_mem_next_allocated(vmem, a, mem->size);   // [a, b) is not in the input file
+      memset(mem->buf + a, 0xff, b - a);
+      while(b < mem->size && vmem->tags[b] & TAG_ALLOCATED)
+        b++;
+    }
 
   // Supports paged load thru post-increment
   if(is_tpi(p) && mem->page_size > 1 && mem->size%mem->page_size == 0 && pgm->cmd_tpi != NULL) {
@@ -422,45 +528,37 @@ int avr_read_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, con
   if((pgm->paged_load && mem->page_size > 1 && mem->size%mem->page_size == 0) ||
     (is_spm(pgm) && avr_has_paged_access(pgm, p, mem))) {
     // The programmer supports a paged mode read
-    int need_read, failure;
-    unsigned int pageaddr;
+    int failure;
     unsigned int npages, nread;
 
-    // Quickly scan number of pages to be written to first
-    for(pageaddr = 0, npages = 0; pageaddr < (unsigned int) mem->size; pageaddr += mem->page_size) {
-      // Check whether this page must be read
-      for(i = pageaddr; i < pageaddr + mem->page_size; i++) {
-        // No verify: read everything; verify: only read needed pages in input file
-        if(vmem == NULL || (mem->tags[i] & TAG_ALLOCATED) != 0) {
-          npages++;
-          break;
-        }
+    // No verify: read every page; verify: only read pages that contain data of the input file
+    unsigned int *pages = avr_pages_in_use(vmem, mem->size, mem->page_size, &npages);
+
+    pmsg_debug("%s(): reading %u of %d pages\n", __func__, npages, mem->size/mem->page_size);
+    failure = 0;
+    // Keep several page requests in flight if the programmer can queue them
+    if(pgm->paged_load_async && pgm->paged_load_collect && npages > 1) {
+      rc = avr_paged_load_pipelined(pgm, p, mem, pages, npages);
+      if(rc == LIBAVRDUDE_SUCCESS) {
+        stats_memory(mem->desc, 0, npages, npages*mem->page_size);
+        mmt_free(pages);
+        led_clr(pgm, LED_PGM);
+        return avr_mem_hiaddr(mem);
       }
+      if(rc != LIBAVRDUDE_NOTSUPPORTED)
+        failure = 1;            // Fall back to byte-at-a-time read below
     }
 
-    for(pageaddr = 0, failure = 0, nread = 0;
-      !failure && pageaddr < (unsigned int) mem->size; pageaddr += mem->page_size) {
-
-      // Check whether this page must be read
-      for(i = pageaddr, need_read = 0; i < pageaddr + mem->page_size; i++) {
-        // No verify: read everything; verify: only read needed pages in input file
-        if(vmem == NULL || (vmem->tags[i] & TAG_ALLOCATED) != 0) {
-          need_read = 1;
-          break;
-        }
-      }
-      if(need_read) {
-        rc = pgm->paged_load(pgm, p, mem, mem->page_size, pageaddr, mem->page_size);
-        if(rc < 0)
-          // Paged load failed, fall back to byte-at-a-time read below
-          failure = 1;
-        nread++;
-        report_progress(nread, npages, NULL);
-      } else {
-        pmsg_debug("%s(): skipping page %u: no interesting data\n", __func__, pageaddr/mem->page_size);
-      }
+    for(nread = 0; !failure && nread < npages; nread++) {
+      rc = pgm->paged_load(pgm, p, mem, mem->page_size, pages[nread], mem->page_size);
+      if(rc < 0)
+        // Paged load failed, fall back to byte-at-a-time read below
+        failure = 1;
+      report_progress(nread + 1, npages, NULL);
     }
+    mmt_free(pages);
     if(!failure) {
+      stats_memory(mem->desc, 0, npages, npages*mem->page_size);
       led_clr(pgm, LED_PGM);
       return avr_mem_hiaddr(mem);
     }
@@ -479,24 +577,27 @@ int avr_read_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, con
   }
 
   for(i = 0; i < (unsigned long) mem->size; i++) {
-    if(vmem == NULL || (vmem->tags[i] & TAG_ALLOCATED) != 0) {
-      rc = pgm->read_byte(pgm, p, mem, i, mem->buf + i);
-      if(rc != LIBAVRDUDE_SUCCESS) {
-        pmsg_error("unable to read byte at address 0x%04lx\n", i);
-        if(rc == LIBAVRDUDE_GENERAL_FAILURE) {
-          // pmsg_error("read operation not supported for memory %s\n", mem->desc);
-          report_progress(1, -1, NULL);
-          led_set(pgm, LED_ERR);
-          led_clr(pgm, LED_PGM);
-          return LIBAVRDUDE_NOTSUPPORTED;
-        }
-        pmsg_error("read operation failed for memory %s\n", mem->desc);
+    if(vmem && !(vmem->tags[i] & TAG_ALLOCATED)) {    // Jump to next byte of the input file
+      i = avr_mem_next_allocated(vmem, i, mem->size) - 1;
+      continue;
+    }
+    rc = pgm->read_byte(pgm, p, mem, i, mem->buf + i);
+    if(rc != LIBAVRDUDE_SUCCESS) {
+      pmsg_error("unable to read byte at address 0x%04lx\n", i);
+      if(rc == LIBAVRDUDE_GENERAL_FAILURE) {
+        // pmsg_error("read operation not supported for memory %s\n", mem->desc);
         report_progress(1, -1, NULL);
         led_set(pgm, LED_ERR);
         led_clr(pgm, LED_PGM);
-        return LIBAVRDUDE_SOFTFAIL;
+        return LIBAVRDUDE_NOTSUPPORTED;
       }
+      pmsg_error("read operation failed for memory %s\n", mem->desc);
+      report_progress(1, -1, NULL);
+      led_set(pgm, LED_ERR);
+      led_clr(pgm, LED_PGM);
+      return LIBAVRDUDE_SOFTFAIL;
     }
+    stats_memory(mem->desc, 0, 0, 1);
     report_progress(i, mem->size, NULL);
   }
 
@@ -604,8 +705,31 @@ double avr_timestamp() {
 void init_cx(PROGRAMMER *pgm) {
   if(pgm)
     pgm->flag = 0;              // Clear out remnants of previous session(s)
-  mmt_free(cx);
+  libavrdude_context *old = cx;
+
+  if(old) {                     // Free lookup indices and decoded files of the old context
+    avr_index_invalidate();
+    fileio_cache_free();
+  }
+
   cx = mmt_malloc(sizeof *cx);  // Allocate and initialise context structure
+  if(old) {
+    /*
+     * Parts and programmers of the config file still point to strings from
+     * cache_string(): hand the table and its arena over to the new context
+     * and clear them in the old one, so only cleanup_config() frees them
+     */
+    cx->cfg_hstrings = old->cfg_hstrings;
+    cx->cfg_nhstrings = old->cfg_nhstrings;
+    cx->cfg_nhused = old->cfg_nhused;
+    cx->cfg_arena = old->cfg_arena;
+    cx->cfg_hlookups = old->cfg_hlookups;
+    cx->cfg_hprobes = old->cfg_hprobes;
+    cx->cfg_hmaxprobes = old->cfg_hmaxprobes;
+    old->cfg_hstrings = NULL;
+    old->cfg_arena = NULL;
+    mmt_free(old);
+  }
   (void) avr_ustimestamp();     // Base timestamps from program start
 }
 
@@ -924,6 +1048,53 @@ int avr_write(const PROGRAMMER *pgm, const AVRPART *p, const char *memstr, int s
   return avr_write_mem(pgm, p, m, size, auto_erase);
 }
 
+/*
+ * Write the npages pages of m listed in pages[] overlapping the transfer of the
+ * next page with the device programming the current one. Works like
+ * avr_paged_load_pipelined(): pgm->paged_write_async() queues a page until
+ * it returns LIBAVRDUDE_SOFTFAIL, and pgm->paged_write_collect() awaits the
+ * completion of the oldest page.
+ *
+ * Returns LIBAVRDUDE_SUCCESS, LIBAVRDUDE_NOTSUPPORTED if the programmer
+ * declined the first page or another negative value on failure.
+ */
+static int avr_paged_write_pipelined(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  const unsigned int *pages, unsigned int npages) {
+
+  unsigned int pgsize = m->page_size, head = 0, tail = 0;       // Pages [head, tail) are in flight
+  int rc = LIBAVRDUDE_SUCCESS;
+
+  while(head < npages) {
+    for(; tail < npages; tail++) {
+      rc = pgm->paged_write_async(pgm, p, m, pgsize, pages[tail], pgsize);
+      if(rc == LIBAVRDUDE_SOFTFAIL && head < tail)      // Window full
+        break;
+      if(rc < 0) {
+        if(rc == LIBAVRDUDE_NOTSUPPORTED && tail)       // Only valid for first page
+          rc = LIBAVRDUDE_GENERAL_FAILURE;
+        goto done;
+      }
+    }
+    if(head == tail) {
+      rc = LIBAVRDUDE_GENERAL_FAILURE;
+      goto done;
+    }
+
+    rc = pgm->paged_write_collect(pgm, p, m, pgsize, pages[head], pgsize);
+    if(rc < 0)
+      goto done;
+    head++;
+    report_progress(head, npages, NULL);
+  }
+  rc = LIBAVRDUDE_SUCCESS;
+
+done:
+  if(rc < 0 && rc != LIBAVRDUDE_NOTSUPPORTED)
+    pmsg_debug("%s(): pipelined write of %s failed after %u of %u pages\n", __func__,
+      m->desc, head, npages);
+  return rc;
+}
+
 int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int size, int auto_erase) {
   int wsize;
   unsigned int i, lastaddr;
@@ -1028,7 +1199,7 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
     (is_spm(pgm) && avr_has_paged_access(pgm, p, m))) {
 
     // The programmer supports a paged mode write
-    int need_write, failure, nset;
+    int failure, nset;
     unsigned int pageaddr;
     unsigned int npages, nwritten;
 
@@ -1066,7 +1237,11 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
     // Set cwsize as rounded-up wsize
     int cwsize = (wsize + pgsize - 1)/pgsize*pgsize;
 
-    for(pageaddr = 0; pageaddr < (unsigned int) cwsize; pageaddr += pgsize) {
+    // Only effective pages with data can have holes that need filling in
+    unsigned int *pages = avr_pages_in_use(cm, cwsize, pgsize, &npages);
+
+    for(unsigned int k = 0; k < npages; k++) {
+      pageaddr = pages[k];
       for(i = pageaddr, nset = 0; i < pageaddr + pgsize; i++)
         if(cm->tags[i] & TAG_ALLOCATED)
           nset++;
@@ -1098,45 +1273,46 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
       }
     }
 
-    // Quickly scan number of pages to be written to
-    for(pageaddr = 0, npages = 0; pageaddr < (unsigned int) cwsize; pageaddr += cm->page_size) {
-      for(i = pageaddr; i < pageaddr + cm->page_size; i++)
-        if(cm->tags[i] & TAG_ALLOCATED) {
-          npages++;
-          break;
-        }
-    }
+    mmt_free(pages);
 
-    for(pageaddr = 0, failure = 0, nwritten = 0;
-      !failure && pageaddr < (unsigned int) cwsize; pageaddr += cm->page_size) {
+    // Pages to be written to
+    pages = avr_pages_in_use(cm, cwsize, cm->page_size, &npages);
+    pmsg_debug("%s(): writing %u of %d pages\n", __func__, npages, cwsize/cm->page_size);
 
-      // Check whether this page must be written to
-      for(i = pageaddr, need_write = 0; i < pageaddr + cm->page_size; i++)
-        if((cm->tags[i] & TAG_ALLOCATED) != 0) {
-          need_write = 1;
-          break;
-        }
+    int page_erase = auto_erase && pgm->page_erase && !mem_is_eeprom(cm);
 
-      if(need_write) {
-        int rc = 0;
-
-        if(auto_erase && pgm->page_erase && !mem_is_eeprom(cm))
-          rc = pgm->page_erase(pgm, p, cm, pageaddr);
-        if(rc >= 0)
-          rc = pgm->paged_write(pgm, p, cm, cm->page_size, pageaddr, cm->page_size);
-        if(rc < 0)
-          failure = 1;          // Paged write failed, fall back to byte-at-a-time write below
-        nwritten++;
-        report_progress(nwritten, npages, NULL);
-      } else {
-        pmsg_debug("%s(): skipping page %u: no interesting data\n", __func__, pageaddr/cm->page_size);
-      }
+    // Overlap page transfer with page programming if the programmer can; not with page erase
+    int pipelined = 0;
+
+    failure = 0;
+    if(pgm->paged_write_async && pgm->paged_write_collect && !page_erase && npages > 1) {
+      int rc = avr_paged_write_pipelined(pgm, p, cm, pages, npages);
+
+      if(rc == LIBAVRDUDE_SUCCESS)
+        pipelined = 1;
+      else if(rc != LIBAVRDUDE_NOTSUPPORTED)
+        failure = 1;            // Fall back to byte-at-a-time write below
     }
 
+    for(nwritten = 0; !pipelined && !failure && nwritten < npages; nwritten++) {
+      int rc = 0;
+
+      pageaddr = pages[nwritten];
+      if(page_erase)
+        rc = pgm->page_erase(pgm, p, cm, pageaddr);
+      if(rc >= 0)
+        rc = pgm->paged_write(pgm, p, cm, cm->page_size, pageaddr, cm->page_size);
+      if(rc < 0)
+        failure = 1;            // Paged write failed, fall back to byte-at-a-time write below
+      report_progress(nwritten + 1, npages, NULL);
+    }
+
+    mmt_free(pages);
     avr_free_mem(cm);
     mmt_free(spc);
 
     if(!failure) {
+      stats_memory(m->desc, 1, npages, npages*m->page_size);
       led_clr(pgm, LED_PGM);
       return wsize;
     }
@@ -1186,6 +1362,7 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
         led_set(pgm, LED_ERR);
         goto error;
       }
+      stats_memory(m->desc, 1, 0, 1);
     }
 
     if(flush_page) {            // Time to flush the page with a page write
@@ -1299,6 +1476,9 @@ int avr_verify(const PROGRAMMER *pgm, const AVRPART *p, const AVRPART *v, const
   return avr_verify_mem(pgm, p, v, a, size);
 }
 
+// Block size for comparing device and input before looking at individual bytes
+#define AVR_VERIFY_BLOCK 64
+
 int avr_verify_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRPART *v, const AVRMEM *a, int size) {
   int i;
   unsigned char *buf1, *buf2;
@@ -1328,6 +1508,11 @@ int avr_verify_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRPART *v, co
   int ro = mem_is_readonly(a);  // Other memories can have known protected zones such as bootloaders
 
   for(i = 0; i < size; i++) {
+    // Fast path: skip whole blocks in which device and input agree
+    if(i%AVR_VERIFY_BLOCK == 0 && size - i >= AVR_VERIFY_BLOCK && !memcmp(buf1 + i, buf2 + i, AVR_VERIFY_BLOCK)) {
+      i += AVR_VERIFY_BLOCK - 1;
+      continue;
+    }
     if((b->tags[i] & TAG_ALLOCATED) != 0 && buf1[i] != buf2[i]) {
       uint8_t bitmask = is_isp(p)? get_fuse_bitmask(a): avr_mem_bitmask(p, a, i);
 
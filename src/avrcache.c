@@ -46,6 +46,9 @@
  *
  * int avr_reset_cache(const PROGRAMMER *pgm, const AVRPART *p);
  *
+ * int avr_write_mem_delta(const PROGRAMMER *pgm, const AVRPART *p, const
+ *  AVRMEM *mem, int size, int *npagesp);
+ *
  * avr_read_byte_cached() and avr_write_byte_cached() use a cache if paged
  * routines are available and if the device memory is flash, EEPROM, bootrow
  * or usersig. The AVRXMEGA memories application, apptable and boot are
@@ -96,6 +99,9 @@
  * Finally, avr_reset_cache() resets the cache without synchronising pending
  * writes() to the device.
  *
+ * avr_write_mem_delta() writes the input file contents of mem through the
+ * cache, so only pages that differ from the device are written and verified.
+ *
  * This file also holds the following utility functions
  *
  * // Does the programmer/memory combo have paged memory access?
@@ -808,3 +814,79 @@ int avr_reset_cache(const PROGRAMMER *pgm, const AVRPART *p_unused) {
 
   return LIBAVRDUDE_SUCCESS;
 }
+
+/*
+ * Write the allocated bytes of mem[0, size) to the device through the cache
+ * so that only pages that differ from the device contents are written. Each
+ * page with data is read from the device and compared; avr_flush_cache()
+ * then writes the changed pages and verifies them by reading them back.
+ *
+ * Returns the number of pages written and stores the number of compared
+ * pages in *npagesp. Returns LIBAVRDUDE_NOTSUPPORTED if mem has no paged
+ * access and another negative value on error.
+ */
+int avr_write_mem_delta(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, int size, int *npagesp) {
+  if(!avr_has_paged_access(pgm, p, mem))
+    return LIBAVRDUDE_NOTSUPPORTED;
+
+  // Compare against the actual device contents, not against stale cache pages
+  if(avr_flush_cache(pgm, p) < 0)
+    return LIBAVRDUDE_GENERAL_FAILURE;
+  avr_reset_cache(pgm, p);
+
+  AVR_Cache *cp = mem_is_eeprom(mem)? pgm->cp_eeprom: mem_is_in_flash(mem)? pgm->cp_flash:
+    mem_is_bootrow(mem)? pgm->cp_bootrow: pgm->cp_usersig;
+  int pgsize = mem->page_size, npages = 0, nchanged = 0, nro = 0;
+
+  if(size > mem->size)
+    size = mem->size;
+
+  for(int base = 0; base < size; base += pgsize) {
+    int next = avr_mem_next_allocated(mem, base, size);
+
+    if(next >= size)            // No more data
+      break;
+    base = next - next%pgsize;  // Jump to next page with data
+    int end = base + pgsize < size? base + pgsize: size, touched = 0;
+
+    report_progress(base, size, NULL);
+    for(int i = base; i < end; i++) {
+      if(!(mem->tags[i] & TAG_ALLOCATED))
+        continue;
+      int rc = avr_write_byte_cached(pgm, p, mem, i, mem->buf[i]);
+
+      if(rc == LIBAVRDUDE_SOFTFAIL)
+        nro++;
+      else if(rc < 0)
+        goto error;
+      touched = 1;
+    }
+    if(touched) {
+      int cacheaddr = cacheAddress(base, cp, mem);
+
+      if(cacheaddr < 0)
+        goto error;
+      npages++;
+      if(memcmp(cp->copy + cacheaddr, cp->cont + cacheaddr, pgsize))
+        nchanged++;
+    }
+  }
+  report_progress(1, 1, NULL);
+
+  if(nro)
+    pmsg_warning("%d byte%s in read-only areas of %s left unchanged\n", nro, str_plural(nro), mem->desc);
+  pmsg_notice("%d of %d %s page%s differ from device\n", nchanged, npages, mem->desc, str_plural(npages));
+
+  if(avr_flush_cache(pgm, p) < 0)
+    goto error;
+  avr_reset_cache(pgm, p);
+
+  if(npagesp)
+    *npagesp = npages;
+  return nchanged;
+
+error:
+  report_progress(1, -1, NULL);
+  avr_reset_cache(pgm, p);
+  return LIBAVRDUDE_GENERAL_FAILURE;
+}
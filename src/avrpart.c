@@ -350,21 +350,37 @@ int avr_initmem(const AVRPART *p) {
   return 0;
 }
 
+/*
+ * Duplicate a memory buffer of size n skipping blocks that are all zero: the
+ * freshly allocated copy is zero already, and large allocations get their
+ * pages from the OS on demand. So, duplicating the tags of a part, which are
+ * mostly zero, or a memory that was never read costs little resident memory.
+ */
+static unsigned char *avr_dup_buf(const unsigned char *src, int n) {
+  unsigned char *ret = mmt_malloc(n);
+  const int bs = 4096;
+
+  for(int i = 0; i < n; i += bs) {
+    int len = n - i < bs? n - i: bs;
+
+    if(src[i] || memcmp(src + i, src + i + 1, len - 1))
+      memcpy(ret + i, src + i, len);
+  }
+
+  return ret;
+}
+
 AVRMEM *avr_dup_mem(const AVRMEM *m) {
   AVRMEM *n = avr_new_mem();
 
   if(m) {
     *n = *m;
 
-    if(m->buf) {
-      n->buf = mmt_malloc(n->size);
-      memcpy(n->buf, m->buf, n->size);
-    }
+    if(m->buf)
+      n->buf = avr_dup_buf(m->buf, n->size);
 
-    if(m->tags) {
-      n->tags = (unsigned char *) mmt_malloc(n->size);
-      memcpy(n->tags, m->tags, n->size);
-    }
+    if(m->tags)
+      n->tags = avr_dup_buf(m->tags, n->size);
 
     for(int i = 0; i < AVR_OP_MAX; i++)
       n->op[i] = avr_dup_opcode(n->op[i]);
@@ -407,6 +423,348 @@ void avr_free_memalias(AVRMEM_ALIAS *m) {
   mmt_free(m);
 }
 
+/*
+ * Lookup indices for parts and memories
+ *
+ * locate_part(), locate_part_by_signature_pm(), avr_locate_mem(),
+ * avr_locate_mem_noalias(), avr_locate_memalias() and
+ * avr_locate_mem_by_type() consult hash indices that are built lazily on
+ * first use and then reused. A part index per list of parts (up to
+ * AVR_PIDX_MAX lists) hashes id, desc and variant names (case-insensitive)
+ * as well as signatures; a memory index per part hashes memory and alias
+ * names and memoises type lookups. Exact names hit the index; unique
+ * initial abbreviations of memory names still need a linear scan.
+ *
+ * Indices are not used while config files are parsed. Each index remembers
+ * the lstamp() of the lists it was built from and is rebuilt once any of
+ * these lists has been modified. Names and signatures edited in place are
+ * caught by checking every hit against the part or memory returned and by
+ * falling back to the linear scan on a miss. avr_index_invalidate() drops
+ * all indices.
+ */
+
+typedef struct {
+  char *name;                   // NULL marks an unused slot
+  AVRPART *p;
+} Avr_pname;
+
+typedef struct {
+  unsigned sig;                 // Signature bytes in bits 23..0
+  int next;                     // Next part with same signature hash, -1 ends the chain
+  AVRPART *p;
+} Avr_psig;
+
+struct avr_part_index {
+  struct avr_part_index *next; // Index of another list
+  LISTID parts;                 // List the index was built for
+  int gen;                      // Generation at the time
+  unsigned stamp;               // lstamp(parts) at the time, 0 for a stale index
+  unsigned nnames;              // Number of name slots (power of 2)
+  Avr_pname *names;
+  unsigned nsigheads;           // Number of signature chains (power of 2)
+  int *sighead, nsigs;
+  Avr_psig *sigs;
+};
+
+#define AVR_PIDX_MAX 4          // Number of part lists that keep an index
+#define AVR_MIDX_TYPES 32       // Number of memoised type lookups per part
+
+struct avr_mem_index {
+  const AVRPART *p;             // Part the index was built for
+  int gen;                      // Generation at the time
+  unsigned mstamp, astamp;      // lstamp() of memory and alias lists at the time, 0 if NULL
+  unsigned nslots;              // Number of name slots (power of 2)
+  int nbytype;                  // Number of memoised type lookups
+  struct {
+    const char *name;           // NULL marks an unused slot
+    AVRMEM *mem;
+    AVRMEM_ALIAS *alias;
+  } *slots;
+  struct {
+    int used;
+    Memtype type;
+    AVRMEM *mem;                // Result of avr_locate_mem_by_type(p, type), may be NULL
+  } bytype[AVR_MIDX_TYPES];
+};
+
+static unsigned avr_hash(const char *s, size_t n, int nocase) {
+  unsigned h = 2166136261U;
+
+  while(n--) {
+    unsigned c = (unsigned char) *s++;
+
+    h = (h ^ (nocase? (unsigned) tolower(c): c))*16777619U;
+  }
+  return h;
+}
+
+static unsigned avr_pow2(unsigned n) {
+  unsigned ret = 16;
+
+  while(ret < n)
+    ret <<= 1;
+  return ret;
+}
+
+static void avr_free_part_index(struct avr_part_index *x) {
+  if(x) {
+    for(unsigned i = 0; i < x->nnames; i++)
+      mmt_free(x->names[i].name);
+    mmt_free(x->names);
+    mmt_free(x->sighead);
+    mmt_free(x->sigs);
+    mmt_free(x);
+  }
+}
+
+static void avr_free_mem_index(struct avr_mem_index *x) {
+  if(x) {
+    mmt_free(x->slots);
+    mmt_free(x);
+  }
+}
+
+// Drop all part and memory indices; they will be rebuilt when next needed
+void avr_index_invalidate(void) {
+  for(struct avr_part_index *x; (x = cx->avr_pidx); avr_free_part_index(x))
+    cx->avr_pidx = x->next;
+  for(int i = 0; i < cx->avr_nmidx; i++)
+    avr_free_mem_index(cx->avr_midx[i]);
+  mmt_free(cx->avr_midx);
+  cx->avr_midx = NULL;
+  cx->avr_nmidx = 0;
+  cx->avr_nmidx_used = 0;
+  cx->avr_idx_gen++;
+}
+
+// Enter name[0..len-1] into part name index unless it is already there (first part wins)
+static void avr_pidx_add(struct avr_part_index *x, const char *name, size_t len, AVRPART *p) {
+  unsigned i = avr_hash(name, len, 1) & (x->nnames - 1);
+
+  for(; x->names[i].name; i = (i + 1) & (x->nnames - 1))
+    if(strlen(x->names[i].name) == len && !strncasecmp(x->names[i].name, name, len))
+      return;
+  x->names[i].name = mmt_malloc(len + 1);
+  memcpy(x->names[i].name, name, len);
+  x->names[i].p = p;
+}
+
+// Return part index for the list parts, building it if needed; NULL if indices are switched off
+static struct avr_part_index *avr_part_index(const LISTID parts) {
+  struct avr_part_index *x, **xp;
+  int nparts = lsize(parts), n = 0;
+
+  if(cx->avr_idx_off)
+    return NULL;
+
+  for(xp = &cx->avr_pidx; (x = *xp) && x->parts != parts; xp = &x->next)
+    n++;
+  if(x) {                       // Unlink from its place to move it to the front
+    *xp = x->next;
+    if(x->gen == cx->avr_idx_gen && x->stamp == lstamp(parts)) {
+      x->next = cx->avr_pidx;
+      cx->avr_pidx = x;
+      return x;
+    }
+    avr_free_part_index(x);
+  } else if(n >= AVR_PIDX_MAX) {        // Drop the least recently used index
+    for(xp = &cx->avr_pidx; (*xp)->next; xp = &(*xp)->next)
+      continue;
+    avr_free_part_index(*xp);
+    *xp = NULL;
+  }
+
+  x = mmt_malloc(sizeof *x);
+  x->next = cx->avr_pidx;
+  cx->avr_pidx = x;
+  x->parts = parts;
+  x->gen = cx->avr_idx_gen;
+  x->stamp = lstamp(parts);
+
+  unsigned nnames = 0;
+
+  for(LNODEID ln = lfirst(parts); ln; ln = lnext(ln))
+    nnames += 2 + 2*lsize(((AVRPART *) ldata(ln))->variants);
+  x->nnames = avr_pow2(2*nnames);
+  x->names = mmt_malloc(x->nnames*sizeof *x->names);
+  x->nsigheads = avr_pow2(nparts);
+  x->sighead = mmt_malloc(x->nsigheads*sizeof *x->sighead);
+  for(unsigned i = 0; i < x->nsigheads; i++)
+    x->sighead[i] = -1;
+  x->sigs = mmt_malloc((nparts + 1)*sizeof *x->sigs);
+
+  for(LNODEID ln = lfirst(parts); ln; ln = lnext(ln)) {
+    AVRPART *p = ldata(ln);
+
+    // Same names as matched by part_eq()
+    avr_pidx_add(x, p->id, strlen(p->id), p);
+    avr_pidx_add(x, p->desc, strlen(p->desc), p);
+    size_t desclen = strlen(p->desc), variantlen, dashlen;
+
+    for(LNODEID lv = lfirst(p->variants); lv; lv = lnext(lv)) {
+      const char *q = (const char *) ldata(lv), *qdash = strchr(q, '-'), *qcolon = strchr(q, ':');
+
+      variantlen = qcolon? (size_t) (qcolon - q): strlen(q);
+      dashlen = qdash? (size_t) (qdash - q): variantlen;
+      if(variantlen < 1024 && (variantlen != desclen || memcmp(q, p->desc, desclen))) {
+        avr_pidx_add(x, q, variantlen, p);
+        if(dashlen > desclen && dashlen < variantlen)
+          avr_pidx_add(x, q, dashlen, p);
+      }
+    }
+
+    // Signatures in list order, skipping stump entries as locate_part_by_signature_pm() does
+    if(!*p->id || *p->id == '.')
+      continue;
+    if(is_memset(p->signature, 0xff, 3) || is_memset(p->signature, 0, 3))
+      continue;
+    unsigned sig = p->signature[0]<<16 | p->signature[1]<<8 | p->signature[2];
+    int *tail = x->sighead + (avr_hash((char *) p->signature, 3, 0) & (x->nsigheads - 1));
+
+    while(*tail >= 0)
+      tail = &x->sigs[*tail].next;
+    *tail = x->nsigs;
+    x->sigs[x->nsigs].sig = sig;
+    x->sigs[x->nsigs].p = p;
+    x->sigs[x->nsigs].next = -1;
+    x->nsigs++;
+  }
+
+  return x;
+}
+
+static AVRPART *avr_pidx_find(const struct avr_part_index *x, const char *name) {
+  unsigned i = avr_hash(name, strlen(name), 1) & (x->nnames - 1);
+
+  for(; x->names[i].name; i = (i + 1) & (x->nnames - 1))
+    if(str_caseeq(x->names[i].name, name))
+      return x->names[i].p;
+  return NULL;
+}
+
+static AVRPART *avr_pidx_find_sig(const struct avr_part_index *x, const unsigned char *sig, int prog_modes) {
+  unsigned s = sig[0]<<16 | sig[1]<<8 | sig[2];
+
+  for(int i = x->sighead[avr_hash((char *) sig, 3, 0) & (x->nsigheads - 1)]; i >= 0; i = x->sigs[i].next)
+    if(x->sigs[i].sig == s && x->sigs[i].p->prog_modes & prog_modes)
+      return x->sigs[i].p;
+  return NULL;
+}
+
+// Open-addressing slot of the memory index for part p; dead entries have x->p == NULL
+static int avr_midx_slot(const AVRPART *p) {
+  int i = avr_hash((char *) &p, sizeof p, 0) & (cx->avr_nmidx - 1), dead = -1;
+  struct avr_mem_index *x;
+
+  for(; (x = cx->avr_midx[i]); i = (i + 1) & (cx->avr_nmidx - 1)) {
+    if(x->p == p)
+      return i;
+    if(!x->p && dead < 0)
+      dead = i;
+  }
+  return dead >= 0? dead: i;
+}
+
+// Mark memory index of part p (about to be freed) as dead
+static void avr_drop_mem_index(const AVRPART *p) {
+  struct avr_mem_index *x;
+
+  if(cx->avr_nmidx && (x = cx->avr_midx[avr_midx_slot(p)]) && x->p == p) {
+    mmt_free(x->slots);
+    memset(x, 0, sizeof *x);
+  }
+}
+
+// Return memory index of part p, building it if needed; NULL if indices are switched off
+static struct avr_mem_index *avr_mem_index(const AVRPART *p) {
+  struct avr_mem_index *x;
+  int i, nmem, nalias;
+  unsigned mstamp, astamp;
+
+  if(cx->avr_idx_off || !p)
+    return NULL;
+
+  nmem = p->mem? lsize(p->mem): 0;
+  nalias = p->mem_alias? lsize(p->mem_alias): 0;
+  mstamp = p->mem? lstamp(p->mem): 0;
+  astamp = p->mem_alias? lstamp(p->mem_alias): 0;
+
+  if(2*(cx->avr_nmidx_used + 1) > cx->avr_nmidx) { // Grow table, dropping dead entries
+    struct avr_mem_index **old = cx->avr_midx;
+    int nold = cx->avr_nmidx;
+
+    cx->avr_nmidx = nold? 2*nold: 16;
+    cx->avr_midx = mmt_malloc(cx->avr_nmidx*sizeof *cx->avr_midx);
+    cx->avr_nmidx_used = 0;
+    for(int k = 0; k < nold; k++)
+      if(old[k] && old[k]->p) {
+        cx->avr_midx[avr_midx_slot(old[k]->p)] = old[k];
+        cx->avr_nmidx_used++;
+      } else
+        mmt_free(old[k]);
+    mmt_free(old);
+  }
+
+  i = avr_midx_slot(p);
+  if((x = cx->avr_midx[i]) && x->p == p) {
+    if(x->gen == cx->avr_idx_gen && x->mstamp == mstamp && x->astamp == astamp)
+      return x;
+    mmt_free(x->slots);         // Stale: rebuild in place
+    memset(x, 0, sizeof *x);
+  } else if(x) {                // Reuse dead entry
+    memset(x, 0, sizeof *x);
+  } else {
+    x = cx->avr_midx[i] = mmt_malloc(sizeof *x);
+    cx->avr_nmidx_used++;
+  }
+
+  x->p = p;
+  x->gen = cx->avr_idx_gen;
+  x->mstamp = mstamp;
+  x->astamp = astamp;
+  x->nslots = avr_pow2(2*(nmem + nalias));
+  x->slots = mmt_malloc(x->nslots*sizeof *x->slots);
+
+  if(p->mem)                    // First memory of a name wins as in avr_locate_mem_noalias()
+    for(LNODEID ln = lfirst(p->mem); ln; ln = lnext(ln)) {
+      AVRMEM *m = ldata(ln);
+      unsigned j = avr_hash(m->desc, strlen(m->desc), 0) & (x->nslots - 1);
+
+      while(x->slots[j].name && !str_eq(x->slots[j].name, m->desc))
+        j = (j + 1) & (x->nslots - 1);
+      if(!x->slots[j].name) {
+        x->slots[j].name = m->desc;
+        x->slots[j].mem = m;
+      }
+    }
+  if(p->mem_alias)              // Alias names share the table but are kept apart from memories
+    for(LNODEID ln = lfirst(p->mem_alias); ln; ln = lnext(ln)) {
+      AVRMEM_ALIAS *a = ldata(ln);
+      unsigned j = avr_hash(a->desc, strlen(a->desc), 0) & (x->nslots - 1);
+
+      while(x->slots[j].name && !str_eq(x->slots[j].name, a->desc))
+        j = (j + 1) & (x->nslots - 1);
+      x->slots[j].name = a->desc;
+      if(!x->slots[j].alias)
+        x->slots[j].alias = a;
+    }
+
+  return x;
+}
+
+// Find exact name in memory index; *alias is set to any alias of that name
+static AVRMEM *avr_midx_find(const struct avr_mem_index *x, const char *desc, AVRMEM_ALIAS **alias) {
+  unsigned j = avr_hash(desc, strlen(desc), 0) & (x->nslots - 1);
+
+  *alias = NULL;
+  for(; x->slots[j].name; j = (j + 1) & (x->nslots - 1))
+    if(str_eq(x->slots[j].name, desc)) {
+      *alias = x->slots[j].alias;
+      return x->slots[j].mem;
+    }
+  return NULL;
+}
+
 AVRMEM_ALIAS *avr_locate_memalias(const AVRPART *p, const char *desc) {
   AVRMEM_ALIAS *m, *match;
   LNODEID ln;
@@ -416,6 +774,14 @@ AVRMEM_ALIAS *avr_locate_memalias(const AVRPART *p, const char *desc) {
   if(!p || !desc || !(d1 = *desc) || !p->mem_alias)
     return NULL;
 
+  struct avr_mem_index *x = avr_mem_index(p);
+
+  if(x) {
+    avr_midx_find(x, desc, &match);
+    if(match && str_eq(match->desc, desc))
+      return match;
+  }
+
   l = strlen(desc);
   matches = 0;
   match = NULL;
@@ -441,6 +807,12 @@ AVRMEM *avr_locate_mem_noalias(const AVRPART *p, const char *desc) {
   if(!p || !desc || !(d1 = *desc) || !p->mem)
     return NULL;
 
+  struct avr_mem_index *x = avr_mem_index(p);
+  AVRMEM_ALIAS *alias;
+
+  if(x && (match = avr_midx_find(x, desc, &alias)) && str_eq(match->desc, desc))
+    return match;
+
   l = strlen(desc);
   matches = 0;
   match = NULL;
@@ -484,18 +856,35 @@ AVRMEM *avr_locate_fuse_by_offset(const AVRPART *p, unsigned int off) {
 
 // Return the first memory that shares the type incl any fuse identified by offset in fuses
 AVRMEM *avr_locate_mem_by_type(const AVRPART *p, Memtype type) {
-  AVRMEM *m;
-  Memtype off = type & MEM_FUSEOFF_MASK;
+  AVRMEM *m, *ret = NULL;
+  Memtype qtype = type, off = type & MEM_FUSEOFF_MASK;
+  struct avr_mem_index *x = avr_mem_index(p);
+  unsigned i = 0;
+
+  if(x) {                       // Memoised result?
+    for(i = avr_hash((char *) &qtype, sizeof qtype, 0) % AVR_MIDX_TYPES; x->bytype[i].used; i = (i + 1) % AVR_MIDX_TYPES)
+      if(x->bytype[i].type == qtype)
+        return x->bytype[i].mem;
+  }
 
   type &= ~(Memtype) MEM_FUSEOFF_MASK;
 
   if(p && p->mem)
     for(LNODEID ln = lfirst(p->mem); ln; ln = lnext(ln))
       if((m = ldata(ln))->type & type)
-        if(type != MEM_IS_A_FUSE || off == mem_fuse_offset(m))
-          return m;
+        if(type != MEM_IS_A_FUSE || off == mem_fuse_offset(m)) {
+          ret = m;
+          break;
+        }
 
-  return NULL;
+  if(x && x->nbytype < AVR_MIDX_TYPES/2) {
+    x->bytype[i].used = 1;
+    x->bytype[i].type = qtype;
+    x->bytype[i].mem = ret;
+    x->nbytype++;
+  }
+
+  return ret;
 }
 
 // Return offset of memory data
@@ -1003,6 +1392,7 @@ AVRPART *avr_dup_part(const AVRPART *d) {
 }
 
 void avr_free_part(AVRPART *d) {
+  avr_drop_mem_index(d);
   ldestroy_cb(d->mem, (void (*)(void *)) avr_free_mem);
   d->mem = NULL;
   ldestroy_cb(d->mem_alias, (void (*)(void *)) avr_free_memalias);
@@ -1027,11 +1417,18 @@ AVRPART *locate_part(const LISTID parts, const char *partdesc) {
   if(!parts || !partdesc)
     return NULL;
 
+  struct avr_part_index *x = avr_part_index(parts);
+
+  if(x && (p = avr_pidx_find(x, partdesc)) && part_eq(p, partdesc, str_caseeq))
+    return p;
+
   for(LNODEID ln1 = lfirst(parts); ln1 && !found; ln1 = lnext(ln1)) {
     p = ldata(ln1);
     if(part_eq(p, partdesc, str_caseeq))
       found = 1;
   }
+  if(x && found)                // Index missed a part edited in place: rebuild next time
+    x->stamp = 0;
 
   return found? p: NULL;
 }
@@ -1051,14 +1448,21 @@ AVRPART *locate_part_by_avr910_devcode(const LISTID parts, int devcode) {
 // Return pointer to first part that has signature sig (unless all 0xff or all 0x00); NULL if no match
 AVRPART *locate_part_by_signature_pm(const LISTID parts, unsigned char *sig, int sigsize, int prog_modes) {
   if(parts && sigsize == 3) {
-    for(LNODEID ln = lfirst(parts); ln; ln = lnext(ln)) {
-      AVRPART *p = ldata(ln);
+    struct avr_part_index *x = avr_part_index(parts);
+    AVRPART *p;
 
+    if(x && (p = avr_pidx_find_sig(x, sig, prog_modes)) && !memcmp(p->signature, sig, 3))
+      return p;
+    for(LNODEID ln = lfirst(parts); ln; ln = lnext(ln)) {
+      p = ldata(ln);
       if(!*p->id || *p->id == '.')      // Skip stump entries
         continue;
       if(!is_memset(p->signature, 0xff, 3) && !is_memset(p->signature, 0, 3))
-        if(!memcmp(p->signature, sig, 3) && p->prog_modes & prog_modes)
+        if(!memcmp(p->signature, sig, 3) && p->prog_modes & prog_modes) {
+          if(x)                 // Index missed a part edited in place: rebuild next time
+            x->stamp = 0;
           return p;
+        }
     }
   }
   return NULL;
@@ -1142,6 +1546,7 @@ static int sort_avrparts_compare(const AVRPART *p1, const AVRPART *p2) {
 // Sort the list avrparts of parts
 void sort_avrparts(LISTID avrparts) {
   lsort(avrparts, (int (*)(void *, void *)) sort_avrparts_compare);
+  avr_index_invalidate();
 }
 
 void avr_display(FILE *f, const PROGRAMMER *pgm, const AVRPART *p, const char *prefix, int verbose) {
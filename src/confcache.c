@@ -0,0 +1,647 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Binary snapshot of a parsed configuration file
+ *
+ * int cfg_cache_load(const char *infile);
+ *
+ * void cfg_cache_save(const char *infile);
+ *
+ * read_config() calls cfg_cache_load() before running the parser over the
+ * first configuration file, ie, when the part and programmer lists are
+ * still empty. If a snapshot exists that was written by this very build
+ * for a config file of the same realpath, mtime, size and contents hash,
+ * then the part and programmer lists, the config-wide defaults and the
+ * comments needed by the developer options are reconstructed from the
+ * snapshot, which is read with a single fread() and decoded with hardly
+ * more than memcpy(). Otherwise read_config() parses the file as usual and
+ * calls cfg_cache_save() after a successful parse.
+ *
+ * Snapshots are opt-in: they are only loaded and saved when the environment
+ * variable AVRDUDE_CONF_CACHE names the directory that keeps them; it is
+ * created if needed. Any problem with the snapshot silently falls back to
+ * parsing.
+ */
+
+#include <ac_cfg.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(WIN32)
+#include <direct.h>
+#include <process.h>
+#define cc_mkdir(d) _mkdir(d)
+#define cc_getpid() _getpid()
+#else
+#include <unistd.h>
+#define cc_mkdir(d) mkdir((d), 0777)
+#define cc_getpid() getpid()
+#endif
+
+#include "avrdude.h"
+#include "libavrdude.h"
+#include "config.h"
+
+#define CC_MAGIC "AVRDUDE-confcache-2"
+
+/*
+ * Scalar fields of AVRPART and AVRMEM that are written one by one; strings,
+ * lists and opcodes are written separately. Names and sizes of these fields
+ * go into the snapshot key, so changing the lists or the field types
+ * invalidates existing snapshots. Fields missing here are not restored!
+ */
+#define CC_PART_FIELDS \
+  X(prog_modes) X(mcuid) X(archnum) X(n_interrupts) X(n_page_erase) X(n_boot_sections) \
+  X(boot_section_size) X(hvupdi_variant) X(stk500_devcode) X(avr910_devcode) X(chip_erase_delay) \
+  X(pagel) X(bs2) X(signature) X(usbpid) X(reset_disposition) X(retry_pulse) X(flags) \
+  X(timeout) X(stabdelay) X(cmdexedelay) X(synchloops) X(bytedelay) X(pollindex) X(pollvalue) \
+  X(predelay) X(postdelay) X(pollmethod) \
+  X(ctl_stack_type) X(controlstack) X(flash_instr) X(eeprom_instr) \
+  X(hventerstabdelay) X(progmodedelay) X(latchcycles) X(togglevtg) X(poweroffdelay) \
+  X(resetdelayms) X(resetdelayus) X(hvleavestabdelay) X(resetdelay) X(chiperasepulsewidth) \
+  X(chiperasepolltimeout) X(chiperasetime) X(programfusepulsewidth) X(programfusepolltimeout) \
+  X(programlockpulsewidth) X(programlockpolltimeout) X(synchcycles) X(hvspcmdexedelay) \
+  X(idr) X(rampz) X(spmcr) X(eecr) X(eind) X(mcu_base) X(nvm_base) X(ocd_base) X(syscfg_base) \
+  X(ocdrev) X(autobaud_sync) X(factory_fcpu) X(lineno)
+
+#define CC_MEM_FIELDS \
+  X(type) X(paged) X(size) X(page_size) X(num_pages) X(initval) X(bitmask) X(n_word_writes) \
+  X(offset) X(min_write_delay) X(max_write_delay) X(pwroff_after_write) X(readback) \
+  X(mode) X(delay) X(blocksize) X(readsize) X(pollindex)
+
+// Snapshot key: everything that must match for the snapshot to be used
+typedef struct {
+  char magic[24];
+  char version[64];             // AVRDUDE_FULL_VERSION
+  uint32_t endian;
+  uint64_t layout;              // Hash of the field names and sizes written
+  int64_t mtime, size;
+  uint64_t hash;                // FNV-1a hash of the config file contents
+} Cc_key;
+
+// Sequential reader over the snapshot with sticky error flag
+typedef struct {
+  const unsigned char *p, *end;
+  int err;
+} Cc_rd;
+
+static uint64_t cc_fnv1a(uint64_t h, const void *buf, size_t n) {
+  const unsigned char *s = buf;
+
+  while(n--)
+    h = (h ^ *s++) * 0x100000001b3ULL;
+  return h;
+}
+
+static uint64_t cc_field(uint64_t h, const char *name, size_t size) {
+  uint32_t sz = size;
+
+  h = cc_fnv1a(h, name, strlen(name) + 1);
+  return cc_fnv1a(h, &sz, sizeof sz);
+}
+
+// Hash of the layout of everything written field by field
+static uint64_t cc_layout(void) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+#define X(fld) h = cc_field(h, "p." #fld, sizeof ((AVRPART *) 0)->fld);
+  CC_PART_FIELDS
+#undef X
+#define X(fld) h = cc_field(h, "m." #fld, sizeof ((AVRMEM *) 0)->fld);
+  CC_MEM_FIELDS
+#undef X
+  h = cc_field(h, "cmdbit", sizeof(CMDBIT));
+  h = cc_field(h, "ops", AVR_OP_MAX);
+  h = cc_field(h, "pgm.pin", sizeof ((PROGRAMMER *) 0)->pin);
+  h = cc_field(h, "pgm.conntype", sizeof ((PROGRAMMER *) 0)->conntype);
+  h = cc_field(h, "pgm.pinno", sizeof ((PROGRAMMER *) 0)->pinno);
+
+  return h;
+}
+
+// Compute snapshot file name for infile; returns malloc'd string or NULL
+static char *cc_filename(const char *infile, int mkdirs) {
+  const char *dir = getenv("AVRDUDE_CONF_CACHE");
+
+  if(!dir || !*dir)
+    return NULL;
+  if(mkdirs)
+    cc_mkdir(dir);
+
+  uint64_t h = cc_fnv1a(0xcbf29ce484222325ULL, infile, strlen(infile));
+  const char *fn = strrchr(infile, '/');
+
+#if defined(WIN32)
+  const char *bs = strrchr(infile, '\\');
+
+  if(bs && (!fn || bs > fn))
+    fn = bs;
+#endif
+  fn = fn? fn + 1: infile;
+
+  return mmt_sprintf("%s/%s-%016llx.bin", dir, fn, (unsigned long long) h);
+}
+
+// Fill in the snapshot key for infile; returns 0 on success
+static int cc_key(Cc_key *key, const char *infile) {
+  struct stat sb;
+  unsigned char buf[8192];
+  size_t n;
+  FILE *f;
+
+  memset(key, 0, sizeof *key);
+  if(stat(infile, &sb) < 0 || !(f = fopen(infile, "rb")))
+    return -1;
+
+  key->hash = 0xcbf29ce484222325ULL;
+  while((n = fread(buf, 1, sizeof buf, f)) > 0)
+    key->hash = cc_fnv1a(key->hash, buf, n);
+  fclose(f);
+
+  strncpy(key->magic, CC_MAGIC, sizeof key->magic - 1);
+  strncpy(key->version, AVRDUDE_FULL_VERSION, sizeof key->version - 1);
+  key->endian = 0x01020304;
+  key->layout = cc_layout();
+  key->mtime = (int64_t) sb.st_mtime;
+  key->size = (int64_t) sb.st_size;
+
+  return 0;
+}
+
+// Writing the snapshot
+
+static void cc_wbytes(FILE *f, const void *p, size_t n) {
+  fwrite(p, 1, n, f);
+}
+
+static void cc_wint(FILE *f, int32_t i) {
+  cc_wbytes(f, &i, sizeof i);
+}
+
+static void cc_wstr(FILE *f, const char *s) {
+  if(!s) {
+    cc_wint(f, -1);
+    return;
+  }
+  int32_t n = strlen(s);
+
+  cc_wint(f, n);
+  cc_wbytes(f, s, n);
+}
+
+// List of strings, NULL list is encoded as count -1
+static void cc_wstrlist(FILE *f, LISTID l) {
+  cc_wint(f, l? lsize(l): -1);
+  for(LNODEID ln = l? lfirst(l): NULL; ln; ln = lnext(ln))
+    cc_wstr(f, ldata(ln));
+}
+
+static void cc_wintlist(FILE *f, LISTID l) {
+  cc_wint(f, l? lsize(l): -1);
+  for(LNODEID ln = l? lfirst(l): NULL; ln; ln = lnext(ln))
+    cc_wint(f, *(int *) ldata(ln));
+}
+
+static void cc_wcomments(FILE *f, LISTID l) {
+  cc_wint(f, l? lsize(l): -1);
+  for(LNODEID ln = l? lfirst(l): NULL; ln; ln = lnext(ln)) {
+    COMMENT *c = ldata(ln);
+
+    cc_wstr(f, c->kw);
+    cc_wstrlist(f, c->comms);
+    cc_wint(f, c->rhs);
+  }
+}
+
+static void cc_wops(FILE *f, OPCODE *const *op) {
+  for(int i = 0; i < AVR_OP_MAX; i++) {
+    cc_wbytes(f, op[i]? "\1": "\0", 1);
+    if(op[i])
+      for(int k = 0; k < 32; k++) {
+        cc_wint(f, op[i]->bit[k].type);
+        cc_wint(f, op[i]->bit[k].bitno);
+        cc_wint(f, op[i]->bit[k].value);
+      }
+  }
+}
+
+// Scalars are written field by field, strings, lists and opcodes separately
+static void cc_wpart(FILE *f, const AVRPART *p) {
+#define X(fld) cc_wbytes(f, &p->fld, sizeof p->fld);
+  CC_PART_FIELDS
+#undef X
+  cc_wstr(f, p->desc);
+  cc_wstr(f, p->id);
+  cc_wcomments(f, p->comments);
+  cc_wstrlist(f, p->variants);
+  cc_wstr(f, p->parent_id);
+  cc_wstr(f, p->family_id);
+  cc_wstr(f, p->config_file);
+  cc_wops(f, p->op);
+
+  cc_wint(f, lsize(p->mem));
+  for(LNODEID ln = lfirst(p->mem); ln; ln = lnext(ln)) {
+    AVRMEM *m = ldata(ln);
+
+#define X(fld) cc_wbytes(f, &m->fld, sizeof m->fld);
+    CC_MEM_FIELDS
+#undef X
+    cc_wstr(f, m->desc);
+    cc_wcomments(f, m->comments);
+    cc_wops(f, m->op);
+  }
+
+  // Aliases refer to memories by their index in p->mem
+  cc_wint(f, lsize(p->mem_alias));
+  for(LNODEID ln = lfirst(p->mem_alias); ln; ln = lnext(ln)) {
+    AVRMEM_ALIAS *a = ldata(ln);
+    int idx = -1, i = 0;
+
+    for(LNODEID lm = lfirst(p->mem); lm; lm = lnext(lm), i++)
+      if(ldata(lm) == a->aliased_mem)
+        idx = i;
+    cc_wstr(f, a->desc);
+    cc_wint(f, idx);
+  }
+}
+
+static void cc_wpgm(FILE *f, const PROGRAMMER *pgm) {
+  const char *type = pgm->initpgm? locate_programmer_type_id(pgm->initpgm): NULL;
+
+  cc_wstrlist(f, pgm->id);
+  cc_wstr(f, pgm->desc);
+  cc_wstr(f, type);
+  cc_wcomments(f, pgm->comments);
+  cc_wstr(f, pgm->parent_id);
+  cc_wint(f, pgm->prog_modes);
+  cc_wint(f, pgm->is_serialadapter);
+  cc_wint(f, pgm->extra_features);
+  cc_wbytes(f, pgm->pin, sizeof pgm->pin);
+  cc_wbytes(f, &pgm->conntype, sizeof pgm->conntype);
+  cc_wint(f, pgm->baudrate);
+  cc_wint(f, pgm->usbvid);
+  cc_wintlist(f, pgm->usbpid);
+  cc_wstr(f, pgm->usbdev);
+  cc_wstr(f, pgm->usbsn);
+  cc_wstr(f, pgm->usbvendor);
+  cc_wstr(f, pgm->usbproduct);
+  cc_wintlist(f, pgm->hvupdi_support);
+  cc_wbytes(f, pgm->pinno, sizeof pgm->pinno);
+  cc_wstr(f, pgm->config_file);
+  cc_wint(f, pgm->lineno);
+}
+
+// Write snapshot of the freshly parsed config file infile (best effort)
+void cfg_cache_save(const char *infile) {
+  char *fn, *tmp;
+  Cc_key key;
+  FILE *f;
+
+  if(cc_key(&key, infile) < 0 || !(fn = cc_filename(infile, 1)))
+    return;
+
+  // Write to a temporary file first so concurrent avrdude processes never see a partial snapshot
+  tmp = mmt_sprintf("%s.%ld", fn, (long) cc_getpid());
+  if(!(f = fopen(tmp, "wb"))) {
+    pmsg_debug("cannot write config cache %s\n", tmp);
+    mmt_free(tmp);
+    mmt_free(fn);
+    return;
+  }
+
+  cc_wbytes(f, &key, sizeof key);
+  cc_wstr(f, avrdude_conf_version);
+  cc_wstr(f, default_programmer);
+  cc_wstr(f, default_parallel);
+  cc_wstr(f, default_serial);
+  cc_wstr(f, default_spi);
+  cc_wint(f, default_baudrate);
+  cc_wbytes(f, &default_bitclock, sizeof default_bitclock);
+  cc_wstr(f, default_linuxgpio);
+  cc_wint(f, allow_subshells);
+  cc_wstrlist(f, cfg_get_prologue());
+
+  cc_wint(f, lsize(part_list));
+  for(LNODEID ln = lfirst(part_list); ln; ln = lnext(ln))
+    cc_wpart(f, ldata(ln));
+  cc_wint(f, lsize(programmers));
+  for(LNODEID ln = lfirst(programmers); ln; ln = lnext(ln))
+    cc_wpgm(f, ldata(ln));
+
+  int err = ferror(f);
+
+  if(fclose(f) || err) {
+    remove(tmp);
+  } else {
+#if defined(WIN32)
+    remove(fn);                 // Windows rename() does not replace existing files
+#endif
+    if(rename(tmp, fn) < 0)
+      remove(tmp);
+    else
+      pmsg_debug("wrote config cache %s\n", fn);
+  }
+  mmt_free(tmp);
+  mmt_free(fn);
+}
+
+// Reading the snapshot
+
+static void cc_rbytes(Cc_rd *r, void *p, size_t n) {
+  if(r->err || (size_t) (r->end - r->p) < n) {
+    r->err = 1;
+    memset(p, 0, n);
+    return;
+  }
+  memcpy(p, r->p, n);
+  r->p += n;
+}
+
+static int cc_rint(Cc_rd *r) {
+  int32_t i;
+
+  cc_rbytes(r, &i, sizeof i);
+  return i;
+}
+
+// Return a mmt_malloc'd copy of the next string or NULL
+static char *cc_rstrdup(Cc_rd *r) {
+  int n = cc_rint(r);
+
+  if(r->err || n < 0 || r->end - r->p < n) {
+    if(n != -1)
+      r->err = 1;
+    return NULL;
+  }
+  char *s = mmt_malloc(n + 1);
+
+  memcpy(s, r->p, n);
+  r->p += n;
+  return s;
+}
+
+// Return next string as hashed string (see cache_string()); NULL stays NULL
+static const char *cc_rstr(Cc_rd *r) {
+  char *s = cc_rstrdup(r);
+  const char *ret = s? cache_string(s): NULL;
+
+  mmt_free(s);
+  return ret;
+}
+
+// Read list of strings into list l creating it if needed
+static LISTID cc_rstrlist(Cc_rd *r, LISTID l) {
+  int n = cc_rint(r);
+
+  if(n < 0)
+    return l;
+  if(!l)
+    l = lcreat(NULL, 0);
+  for(int i = 0; i < n && !r->err; i++) {
+    char *s = cc_rstrdup(r);
+
+    if(s)
+      ladd(l, s);
+  }
+  return l;
+}
+
+static void cc_rintlist(Cc_rd *r, LISTID l) {
+  int n = cc_rint(r);
+
+  for(int i = 0; i < n && !r->err; i++) {
+    int *ip = mmt_malloc(sizeof *ip);
+
+    *ip = cc_rint(r);
+    ladd(l, ip);
+  }
+}
+
+static LISTID cc_rcomments(Cc_rd *r) {
+  int n = cc_rint(r);
+
+  if(n < 0)
+    return NULL;
+  LISTID l = lcreat(NULL, 0);
+
+  for(int i = 0; i < n && !r->err; i++) {
+    COMMENT *c = mmt_malloc(sizeof *c);
+
+    c->kw = cc_rstrdup(r);
+    c->comms = cc_rstrlist(r, NULL);
+    c->rhs = cc_rint(r);
+    ladd(l, c);
+  }
+  return l;
+}
+
+static void cc_rops(Cc_rd *r, OPCODE **op) {
+  for(int i = 0; i < AVR_OP_MAX; i++) {
+    unsigned char has;
+
+    cc_rbytes(r, &has, 1);
+    op[i] = NULL;
+    if(has && !r->err) {
+      op[i] = avr_new_opcode();
+      for(int k = 0; k < 32; k++) {
+        op[i]->bit[k].type = cc_rint(r);
+        op[i]->bit[k].bitno = cc_rint(r);
+        op[i]->bit[k].value = cc_rint(r);
+      }
+    }
+  }
+}
+
+static AVRPART *cc_rpart(Cc_rd *r) {
+  AVRPART *p = avr_new_part();
+
+#define X(fld) cc_rbytes(r, &p->fld, sizeof p->fld);
+  CC_PART_FIELDS
+#undef X
+  p->desc = cc_rstr(r);
+  p->id = cc_rstr(r);
+  p->comments = cc_rcomments(r);
+  p->variants = cc_rstrlist(r, p->variants);
+  p->parent_id = cc_rstr(r);
+  p->family_id = cc_rstr(r);
+  p->config_file = cc_rstr(r);
+  cc_rops(r, p->op);
+
+  int nmem = cc_rint(r);
+
+  for(int i = 0; i < nmem && !r->err; i++) {
+    AVRMEM *m = avr_new_mem();
+
+#define X(fld) cc_rbytes(r, &m->fld, sizeof m->fld);
+    CC_MEM_FIELDS
+#undef X
+    m->desc = cc_rstr(r);
+    m->comments = cc_rcomments(r);
+    cc_rops(r, m->op);
+    ladd(p->mem, m);
+  }
+
+  int nalias = cc_rint(r);
+
+  for(int i = 0; i < nalias && !r->err; i++) {
+    AVRMEM_ALIAS *a = avr_new_memalias();
+    int idx;
+
+    a->desc = cc_rstr(r);
+    idx = cc_rint(r);
+    a->aliased_mem = idx >= 0 && idx < nmem? lget_n(p->mem, idx + 1): NULL;
+    ladd(p->mem_alias, a);
+  }
+
+  return p;
+}
+
+static PROGRAMMER *cc_rpgm(Cc_rd *r) {
+  PROGRAMMER *pgm = pgm_new();
+  const char *type;
+
+  cc_rstrlist(r, pgm->id);
+  pgm->desc = cc_rstr(r);
+  if((type = cc_rstr(r))) {
+    const PROGRAMMER_TYPE *pt = locate_programmer_type(type);
+
+    if(!pt)
+      r->err = 1;
+    else
+      pgm->initpgm = pt->initpgm;
+  }
+  pgm->comments = cc_rcomments(r);
+  pgm->parent_id = cc_rstr(r);
+  pgm->prog_modes = cc_rint(r);
+  pgm->is_serialadapter = cc_rint(r);
+  pgm->extra_features = cc_rint(r);
+  cc_rbytes(r, pgm->pin, sizeof pgm->pin);
+  cc_rbytes(r, &pgm->conntype, sizeof pgm->conntype);
+  pgm->baudrate = cc_rint(r);
+  pgm->usbvid = cc_rint(r);
+  cc_rintlist(r, pgm->usbpid);
+  pgm->usbdev = cc_rstr(r);
+  pgm->usbsn = cc_rstr(r);
+  pgm->usbvendor = cc_rstr(r);
+  pgm->usbproduct = cc_rstr(r);
+  cc_rintlist(r, pgm->hvupdi_support);
+  cc_rbytes(r, pgm->pinno, sizeof pgm->pinno);
+  pgm->config_file = cc_rstr(r);
+  pgm->lineno = cc_rint(r);
+
+  return pgm;
+}
+
+/*
+ * Populate part_list, programmers and config-wide defaults from a snapshot
+ * of infile; returns 0 if the snapshot was used and -1 if infile needs
+ * parsing
+ */
+int cfg_cache_load(const char *infile) {
+  Cc_key key, fkey;
+  unsigned char *buf = NULL;
+  char *fn;
+  FILE *f;
+  long len;
+  Cc_rd r;
+
+  if(!(fn = cc_filename(infile, 0)))
+    return -1;
+  if(!(f = fopen(fn, "rb"))) {
+    mmt_free(fn);
+    return -1;
+  }
+
+  if(cc_key(&key, infile) < 0 || fread(&fkey, sizeof fkey, 1, f) != 1 || memcmp(&key, &fkey, sizeof key))
+    goto fail;
+  if(fseek(f, 0, SEEK_END) < 0 || (len = ftell(f)) < (long) sizeof key || fseek(f, sizeof key, SEEK_SET) < 0)
+    goto fail;
+  len -= sizeof key;
+  buf = mmt_malloc(len + 1);
+  if(fread(buf, 1, len, f) != (size_t) len)
+    goto fail;
+  fclose(f);
+  f = NULL;
+
+  r.p = buf;
+  r.end = buf + len;
+  r.err = 0;
+
+  // Decode into fresh lists so a corrupt snapshot does not leave partial entries behind
+  const char *conf_version = cc_rstr(&r), *dpgm = cc_rstr(&r), *dpar = cc_rstr(&r);
+  const char *dser = cc_rstr(&r), *dspi = cc_rstr(&r);
+  int dbaud = cc_rint(&r);
+  double dbitclock;
+
+  cc_rbytes(&r, &dbitclock, sizeof dbitclock);
+  const char *dgpio = cc_rstr(&r);
+  int subshells = cc_rint(&r);
+  LISTID prologue = cc_rstrlist(&r, NULL);
+
+  LISTID parts = lcreat(NULL, 0), pgms = lcreat(NULL, 0);
+  int n = cc_rint(&r);
+
+  for(int i = 0; i < n && !r.err; i++)
+    ladd(parts, cc_rpart(&r));
+  n = cc_rint(&r);
+  for(int i = 0; i < n && !r.err; i++)
+    ladd(pgms, cc_rpgm(&r));
+
+  if(r.err || r.p != r.end) {
+    pmsg_debug("ignoring corrupt config cache %s\n", fn);
+    ldestroy_cb(parts, (void (*)(void *)) avr_free_part);
+    ldestroy_cb(pgms, (void (*)(void *)) pgm_free);
+    goto fail;
+  }
+
+  avrdude_conf_version = conf_version;
+  default_programmer = dpgm;
+  default_parallel = dpar;
+  default_serial = dser;
+  default_spi = dspi;
+  default_baudrate = dbaud;
+  default_bitclock = dbitclock;
+  default_linuxgpio = dgpio;
+  allow_subshells = subshells;
+  cx->cfg_prologue = prologue;
+
+  for(LNODEID ln = lfirst(parts); ln; ln = lnext(ln))
+    ladd(part_list, ldata(ln));
+  for(LNODEID ln = lfirst(pgms); ln; ln = lnext(ln))
+    ladd(programmers, ldata(ln));
+  ldestroy(parts);
+  ldestroy(pgms);
+
+  pmsg_debug("using config cache %s\n", fn);
+  mmt_free(buf);
+  mmt_free(fn);
+  return 0;
+
+fail:
+  if(f)
+    fclose(f);
+  mmt_free(buf);
+  mmt_free(fn);
+  return -1;
+}
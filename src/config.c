@@ -60,6 +60,8 @@ char *cfg_infile;
 
 extern char *yytext;
 
+static void cfg_free_hstrings(void);
+
 #define pgm_comp_desc(x, type)  { #x, COMP_PROGRAMMER, offsetof(PROGRAMMER, x), sizeof(((PROGRAMMER *) NULL)->x), type }
 #define part_comp_desc(x, type) { #x, COMP_AVRPART, offsetof(AVRPART, x), sizeof(((AVRPART *) NULL)->x), type }
 #define mem_comp_desc(x, type)  { #x, COMP_AVRMEM, offsetof(AVRMEM, x), sizeof(((AVRMEM *) NULL)->x), type }
@@ -165,6 +167,9 @@ void cleanup_config(void) {
   ldestroy_cb(programmers, (void (*)(void *)) pgm_free);
   ldestroy_cb(string_list, (void (*)(void *)) free_token);
   ldestroy_cb(number_list, (void (*)(void *)) free_token);
+  part_list = programmers = string_list = number_list = NULL;
+  avr_index_invalidate();
+  cfg_free_hstrings();          // Last: the freed parts and programmers pointed into the arena
 }
 
 int init_config(void) {
@@ -183,14 +188,14 @@ int init_config(void) {
   return 0;
 }
 
+// Zeroed allocation via calloc(), which leaves untouched pages of large blocks unmapped
 void *cfg_malloc(const char *funcname, size_t n) {
-  void *ret = malloc(n);
+  void *ret = calloc(1, n? n: 1);
 
   if(!ret) {
     pmsg_error("out of memory in %s() for malloc(); needed %lu bytes\n", funcname, (unsigned long) n);
     exit(1);
   }
-  memset(ret, 0, n);
   return ret;
 }
 
@@ -422,13 +427,22 @@ extern int yylex_destroy(void);
 
 int read_config(const char *file) {
   FILE *f;
-  int r;
+  int r, cacheable;
 
   if(!(cfg_infile = realpath(file, NULL))) {
     pmsg_ext_error("cannot determine realpath() of config file %s: %s\n", file, strerror(errno));
     return -1;
   }
 
+  // Snapshots are only used for the first config file, as later ones can refer to or modify entries
+  cacheable = !lsize(part_list) && !lsize(programmers);
+  if(cacheable && cfg_cache_load(cfg_infile) == 0) {
+    avr_index_invalidate();
+    mmt_free(cfg_infile);
+    cfg_infile = NULL;
+    return 0;
+  }
+
   f = fopen(cfg_infile, "r");
   if(f == NULL) {
     pmsg_ext_error("cannot open config file %s: %s\n", cfg_infile, strerror(errno));
@@ -440,7 +454,10 @@ int read_config(const char *file) {
   cfg_lineno = 1;
   yyin = f;
 
+  cx->avr_idx_off++;            // The grammar modifies parts and lists all the time
   r = yyparse();
+  cx->avr_idx_off--;
+  avr_index_invalidate();
 
 #ifdef HAVE_YYLEX_DESTROY
   // Reset lexer and free any allocated memory
@@ -449,6 +466,9 @@ int read_config(const char *file) {
 
   fclose(f);
 
+  if(r == 0 && cacheable)
+    cfg_cache_save(cfg_infile);
+
   if(cfg_infile) {
     mmt_free(cfg_infile);
     cfg_infile = NULL;
@@ -459,36 +479,122 @@ int read_config(const char *file) {
 
 // Adapted version of a neat empirical hash function from comp.lang.c by Daniel Bernstein
 unsigned strhash(const char *str) {
-  unsigned c, hash = 5381, n = 0;
+  unsigned c, hash = 5381;
 
-  while((c = (unsigned char) *str++) && n++ < 20)
+  while((c = (unsigned char) *str++))
     hash = 33*hash ^ c;
 
   return hash;
 }
 
+#define CFG_ARENA_SIZE 65536    // Default size of arena blocks for hashed strings
+
+typedef struct cfg_arena {
+  struct cfg_arena *next;
+  size_t size, used;
+  char data[];
+} Cfg_arena;
+
+typedef struct cfg_hstring {
+  unsigned hash;                // Full strhash() of str
+  const char *str;              // NULL marks an unused slot
+} Cfg_hstring;
+
+// Mix bits of hash h so that the low bits of similar strings differ
+static unsigned cfg_hmix(unsigned h) {
+  h ^= h >> 16, h *= 0x85ebca6bU, h ^= h >> 13, h *= 0xc2b2ae35U, h ^= h >> 16;
+  return h;
+}
+
+// Slot for string p with hash h: either where p is or the empty slot where it would go
+static size_t cfg_hslot(const char *p, unsigned h) {
+  size_t mask = cx->cfg_nhstrings - 1, i, probes = 1;
+
+  for(i = cfg_hmix(h) & mask; cx->cfg_hstrings[i].str; i = (i + 1) & mask, probes++)
+    if(cx->cfg_hstrings[i].hash == h && str_eq(p, cx->cfg_hstrings[i].str))
+      break;
+
+  cx->cfg_hlookups++;
+  cx->cfg_hprobes += probes;
+  if(probes > cx->cfg_hmaxprobes)
+    cx->cfg_hmaxprobes = probes;
+
+  return i;
+}
+
+// Copy of string p of length len in the arena of hashed strings
+static const char *cfg_arena_strdup(const char *p, size_t len) {
+  Cfg_arena *a = cx->cfg_arena;
+
+  if(!a || a->size - a->used < len + 1) {
+    size_t size = len + 1 > CFG_ARENA_SIZE? len + 1: CFG_ARENA_SIZE;
+
+    a = mmt_malloc(sizeof *a + size);
+    a->size = size;
+    a->next = cx->cfg_arena;
+    cx->cfg_arena = a;
+  }
+  char *ret = a->data + a->used;
+
+  memcpy(ret, p, len + 1);
+  a->used += len + 1;
+
+  return ret;
+}
+
 // Return a copy of the argument as hashed string
 const char *cache_string(const char *p) {
-  int h, k;
-  char **hs;
+  unsigned h;
+  size_t i;
 
   if(!p)
     p = "(NULL)";
 
-  h = strhash(p)%(sizeof cx->cfg_hstrings/sizeof *cx->cfg_hstrings);
-  if(!(hs = cx->cfg_hstrings[h]))
-    hs = cx->cfg_hstrings[h] = (char **) mmt_realloc(NULL, (16 + 1)*sizeof **cx->cfg_hstrings);
+  // Keep the load factor of the open-addressing table below 2/3
+  if(3*(cx->cfg_nhused + 1) > 2*cx->cfg_nhstrings) {
+    Cfg_hstring *old = cx->cfg_hstrings;
+    size_t nold = cx->cfg_nhstrings;
 
-  for(k = 0; hs[k]; k++)
-    if(*p == *hs[k] && str_eq(p, hs[k]))
-      return hs[k];
+    cx->cfg_nhstrings = nold? 2*nold: 1024;
+    cx->cfg_hstrings = mmt_malloc(cx->cfg_nhstrings*sizeof *cx->cfg_hstrings);
+    size_t mask = cx->cfg_nhstrings - 1;
 
-  if(k && k%16 == 0)
-    cx->cfg_hstrings[h] = (char **) mmt_realloc(cx->cfg_hstrings[h], (k + 16 + 1)*sizeof **cx->cfg_hstrings);
+    for(size_t k = 0; k < nold; k++)    // Strings are unique: put them in the first free slot
+      if(old[k].str) {
+        for(i = cfg_hmix(old[k].hash) & mask; cx->cfg_hstrings[i].str; i = (i + 1) & mask)
+          continue;
+        cx->cfg_hstrings[i] = old[k];
+      }
+    mmt_free(old);
+  }
+
+  h = strhash(p);
+  i = cfg_hslot(p, h);
+  if(!cx->cfg_hstrings[i].str) {
+    cx->cfg_hstrings[i].hash = h;
+    cx->cfg_hstrings[i].str = cfg_arena_strdup(p, strlen(p));
+    cx->cfg_nhused++;
+  }
+
+  return cx->cfg_hstrings[i].str;
+}
 
-  cx->cfg_hstrings[h][k + 1] = NULL;
+// Free all hashed strings in one go; pointers returned by cache_string() become invalid
+static void cfg_free_hstrings(void) {
+  if(cx->cfg_hlookups)
+    pmsg_debug("cache_string(): %lu strings in %lu slots, %.2f probes per lookup, longest chain %lu\n",
+      (unsigned long) cx->cfg_nhused, (unsigned long) cx->cfg_nhstrings,
+      (double) cx->cfg_hprobes/cx->cfg_hlookups, (unsigned long) cx->cfg_hmaxprobes);
 
-  return cx->cfg_hstrings[h][k] = mmt_strdup(p);
+  for(Cfg_arena *a = cx->cfg_arena, *next; a; a = next) {
+    next = a->next;
+    mmt_free(a);
+  }
+  cx->cfg_arena = NULL;
+  mmt_free(cx->cfg_hstrings);
+  cx->cfg_hstrings = NULL;
+  cx->cfg_nhstrings = cx->cfg_nhused = 0;
+  cx->cfg_hlookups = cx->cfg_hprobes = cx->cfg_hmaxprobes = 0;
 }
 
 COMMENT *locate_comment(const LISTID comments, const char *where, int rhs) {
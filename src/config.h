@@ -137,6 +137,10 @@ extern "C" {
 
   LISTID cfg_get_prologue(void);
 
+  int cfg_cache_load(const char *infile);
+
+  void cfg_cache_save(const char *infile);
+
   void capture_comment_str(const char *com, int lineno);
 
   void capture_lvalue_kw(const char *kw, int lineno);
@@ -383,6 +383,61 @@ static const char *cycles(int mnemo) {
   return ret;
 }
 
+// Slot in the destination hash table for jumpcalls to address to
+static int *jumpcall_slot(int to) {
+  unsigned mask = cx->dis_jchashsize - 1, h = ((unsigned) to*2654435761u) & mask;
+
+  while(cx->dis_jchash[h] && cx->dis_jumpcalls[cx->dis_jchash[h] - 1].to != to)
+    h = (h + 1) & mask;
+
+  return cx->dis_jchash + h;
+}
+
+// (Re)build the destination hash table for at least n jumpcalls
+static void hash_jumpcalls(int n) {
+  Dis_jumpcall *jc = cx->dis_jumpcalls;
+
+  mmt_free(cx->dis_jchash);
+  for(cx->dis_jchashsize = 1024; cx->dis_jchashsize < 2*n; cx->dis_jchashsize *= 2)
+    continue;
+  cx->dis_jchash = mmt_malloc(cx->dis_jchashsize*sizeof *cx->dis_jchash);
+  for(int i = 0; i < cx->dis_jumpcallN; i++) {
+    int *slot = jumpcall_slot(jc[i].to);
+
+    jc[i].next = *slot;
+    *slot = i + 1;
+  }
+}
+
+/*
+ * Index of a jumpcall to destination or -1 if there is none; in pass 2 the
+ * jumpcalls are sorted by destination and this returns the first of them
+ */
+static int find_jumpcall(int destination) {
+  Dis_jumpcall *jc = cx->dis_jumpcalls;
+
+  if(cx->dis_pass == 2) {
+    int lo = 0, hi = cx->dis_jumpcallN;
+
+    while(lo < hi) {
+      int mid = lo + (hi - lo)/2;
+
+      if(jc[mid].to < destination)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo < cx->dis_jumpcallN && jc[lo].to == destination? lo: -1;
+  }
+
+  if(!cx->dis_jumpcallN)
+    return -1;
+  if(!cx->dis_jchash)
+    hash_jumpcalls(cx->dis_jumpcallN);
+
+  return *jumpcall_slot(destination) - 1;
+}
+
 static const char *get_label_name(int destination, const char **commentp) {
   Dis_symbol *s = find_symbol('L', destination);
 
@@ -393,9 +448,10 @@ static const char *get_label_name(int destination, const char **commentp) {
     return s->name;
   }
 
-  for(int i = 0; i < cx->dis_jumpcallN; i++)
-    if(cx->dis_jumpcalls[i].to == destination)
-      return str_ccprintf("%s%d", cx->dis_jumpcalls[i].is_func? "Subroutine": "Label", cx->dis_jumpcalls[i].labelno);
+  int i = find_jumpcall(destination);
+
+  if(i >= 0)
+    return str_ccprintf("%s%d", cx->dis_jumpcalls[i].is_func? "Subroutine": "Label", cx->dis_jumpcalls[i].labelno);
 
   return NULL;
 }
@@ -484,13 +540,12 @@ static void lineout(const char *code, const char *comment,
   int here = disasm_wrap(pos + addr);
 
   if(cx->dis_opts.labels && showlabel) {
-    int match = 0, first = -1;
+    int first = find_jumpcall(here), match = first >= 0;
     const char *comment = NULL, *name;
 
-    for(int i = 0; i < cx->dis_jumpcallN; i++)
-      if(jc[i].to == here)
-        if(!match++)
-          first = i;
+    if(cx->dis_pass == 2)
+      for(int i = first + 1; match && i < cx->dis_jumpcallN && jc[i].to == here; i++)
+        match++;
 
     if(cx->dis_pass == 2 && match) {
       cx->dis_para++;
@@ -676,16 +731,22 @@ void disasm_zap_jumpcalls() {
   mmt_free(cx->dis_jumpcalls);
   cx->dis_jumpcalls = NULL;
   cx->dis_jumpcallN = 0;
+  mmt_free(cx->dis_jchash);
+  cx->dis_jchash = NULL;
 }
 
 static void register_jumpcall(int from, int to, int mnemo, int is_func) {
   if(cx->dis_opts.labels) {
     Dis_jumpcall *jc = cx->dis_jumpcalls;
-    int N = cx->dis_jumpcallN;
+    int N = cx->dis_jumpcallN, *slot;
+
+    if(!cx->dis_jchash || 2*(N + 1) > cx->dis_jchashsize)
+      hash_jumpcalls(N + 1);
+    slot = jumpcall_slot(to);
 
     // Already entered this jumpcall?
-    for(int i = 0; i < N; i++)
-      if(jc[i].from == from && jc[i].to == to && jc[i].mnemo == mnemo)
+    for(int i = *slot; i; i = jc[i - 1].next)
+      if(jc[i - 1].from == from && jc[i - 1].mnemo == mnemo)
         return;
 
     if(N%1024 == 0)
@@ -695,6 +756,8 @@ static void register_jumpcall(int from, int to, int mnemo, int is_func) {
     jc[N].mnemo = mnemo;
     jc[N].labelno = 0;
     jc[N].is_func = is_func;
+    jc[N].next = *slot;
+    *slot = N + 1;
 
     cx->dis_jumpcalls = jc;
     cx->dis_jumpcallN++;
@@ -734,6 +797,8 @@ static int jumpcall_sort(const void *v1, const void *v2) {
 static void enumerate_labels(void) {
   if(cx->dis_jumpcallN > 1) {
     qsort(cx->dis_jumpcalls, cx->dis_jumpcallN, sizeof(Dis_jumpcall), jumpcall_sort);
+    mmt_free(cx->dis_jchash);   // Sorting invalidated the hash table
+    cx->dis_jchash = NULL;
     correct_is_funct();
 
     int dest = 987654321, cur_labelno = 0, cur_funcno = 0;
@@ -21,6 +21,10 @@
  * pretending all operations work well.
  */
 
+#if !defined(WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             // For posix_openpt(), grantpt(), unlockpt() and ptsname()
+#endif
+
 #include <ac_cfg.h>
 
 #include <stdio.h>
@@ -34,11 +38,22 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
 #include "avrdude.h"
 #include "libavrdude.h"
 
 #include "dryrun.h"
 #include "dryrun_private.h"
+#include "updi_constants.h"
 
 #define random() rand()         // For platform independence
 #define srandom(n) srand(n)
@@ -61,20 +76,88 @@ typedef struct {
   int datastart, datasize;      // Start and size of application data section (if any)
   int bootstart, bootsize;      // Start and size of boot section (if any)
   int initialised;              // 1 once the part memories are initialised
+  int readwindow;               // Max number of pipelined paged reads in flight (-x readwindow)
+  int rq_n;                     // Number of pipelined paged reads in flight
+  int writewindow;              // Max number of pipelined paged writes in flight (-x writewindow)
+  int wq_n;                     // Number of pipelined paged writes in flight
+  // Timing model (-x timing, -x baud, -x latency)
+  int timing;                   // Account simulated time for all operations
+  int baud;                     // Link rate in bit/s assuming 10 bits per byte
+  int latency;                  // Round-trip latency per command in us
+  double t_host;                // Simulated time in us the host has spent so far
+  double t_dev;                 // Simulated time at which the device is next idle
+  double *rq_done, *wq_done;    // Completion times of pipelined requests in flight
+  int rq_head, wq_head;         // Index of oldest request in flight in rq_done[], wq_done[]
+  uint64_t t_wall;              // Wall clock at open in us
+  // Target emulator (-x serve, -x urboot)
+  char *serve;                  // Where to listen for a client: net:[<host>:]<port> or pty
+  int urboot;                   // Speak urprotocol instead of STK500v1
 } Dryrun_data;
 
 // Use private programmer data as if they were a global structure dry
 #define dry (*(Dryrun_data *)(pgm->cookie))
 
+#define DRY_BAUD 115200         // Default link rate for -x timing
+#define DRY_LATENCY 1000        // Default round-trip latency in us for -x timing
+#define DRY_CMDBYTES 8          // Assumed protocol overhead in bytes per command and response
+
 #define Return(...) do { pmsg_error(__VA_ARGS__); msg_error("\n"); return -1; } while(0)
 #define Retwarning(...) do { pmsg_warning(__VA_ARGS__); \
   msg_warning("; not initialising %s memories\n", p->desc); return -1; } while(0)
 
 static int dryrun_readonly(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, unsigned int addr);
 
+/*
+ * Timing model: the host and the link are busy for the latency and transfer
+ * time of each command, while the device is busy programming after a write
+ * or erase for the delay given in the part description. A synchronous command
+ * waits for the device to be idle; pipelined requests let the host send the
+ * next page while the device is programming the current one.
+ */
+
+// Simulated time in us to transfer n payload bytes plus protocol overhead
+static double dry_xfer(const PROGRAMMER *pgm, int n) {
+  return dry.baud > 0? (n + DRY_CMDBYTES)*10e6/dry.baud: 0;
+}
+
+// Programming time in us of a page or byte of memory m
+static double dry_busy(const AVRMEM *m) {
+  return m->max_write_delay > 0? m->max_write_delay: m->min_write_delay > 0? m->min_write_delay: 0;
+}
+
+// Account for a synchronous command transferring n bytes that keeps the device busy for busy us
+static void dry_command(const PROGRAMMER *pgm, int n, double busy) {
+  if(dry.timing) {
+    if(dry.t_host < dry.t_dev)
+      dry.t_host = dry.t_dev;
+    dry.t_host += dry.latency + dry_xfer(pgm, n) + busy;
+    dry.t_dev = dry.t_host;
+  }
+}
+
+// Account for issuing a pipelined request; return its simulated completion time
+static double dry_issue(const PROGRAMMER *pgm, int nsend, int nreceive, double busy) {
+  double start;
+
+  if(!dry.timing)
+    return 0;
+  dry.t_host += dry_xfer(pgm, nsend);
+  start = dry.t_host > dry.t_dev? dry.t_host: dry.t_dev;
+  dry.t_dev = start + busy + dry_xfer(pgm, nreceive);
+
+  return dry.t_dev + dry.latency;
+}
+
+// Account for the host waiting for a pipelined request that completes at time done
+static void dry_collect(const PROGRAMMER *pgm, double done) {
+  if(dry.timing && dry.t_host < done)
+    dry.t_host = done;
+}
+
 // Read expected signature bytes from part description
 static int dryrun_read_sig_bytes(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *sigmem) {
   pmsg_debug("%s()", __func__);
+  dry_command(pgm, 3, 0);
   // Signature byte reads are always 3 bytes
   if(sigmem->size < 3)
     Return("memory size too small for %s()", __func__);
@@ -91,6 +174,7 @@ static int dryrun_chip_erase(const PROGRAMMER *pgm, const AVRPART *punused) {
   pmsg_debug("%s()\n", __func__);
   if(!dry.dp)
     Return("no dryrun device?");
+  dry_command(pgm, 0, dry.dp->chip_erase_delay);
   if(!(mem = avr_locate_flash(dry.dp)))
     Return("cannot locate %s flash memory for chip erase", dry.dp->desc);
   if(mem->size < 1)
@@ -146,6 +230,7 @@ static int dryrun_page_erase(const PROGRAMMER *pgm, const AVRPART *p, const AVRM
   pmsg_debug("%s(%s, 0x%04x)\n", __func__, m->desc, addr);
   if(!dry.dp)
     Return("no dryrun device?");
+  dry_command(pgm, 0, dry_busy(m));
 
   AVRMEM *dmem;
 
@@ -696,6 +781,973 @@ static void dryrun_enable(PROGRAMMER *pgm, const AVRPART *p) {
   dry.initialised = 1;
 }
 
+/*
+ * Target emulator: -c dryboot -x serve=... listens on a TCP port or a pseudo
+ * terminal and answers STK500v1 (optiboot) or, with -x urboot, urprotocol
+ * requests of another avrdude process, eg, -c arduino -P net:localhost:4242,
+ * using the dryrun memory model; -c dryrun -x serve=... does the same for
+ * SerialUPDI hosts and UPDI parts. This allows end-to-end benchmarks of the
+ * bootloader and SerialUPDI programmers without a board. With -x baud=<n>
+ * responses are throttled to the speed of a serial line with that baud rate.
+ */
+
+#if !defined(WIN32)
+
+typedef struct {
+  int fd;                       // Connection to the client
+  unsigned char in[4096];       // Receive buffer
+  int inhead, inlen;
+  unsigned char out[2048 + 4];  // Response of the current command
+  int outlen;
+  int nio;                      // Number of bytes received for the current command
+  int watchstdin;               // Shut down when standard input (a pipe) is closed
+  int quit;                     // Standard input was closed: shut down
+} Dry_link;
+
+/*
+ * Wait until fd is readable; return -1 if watchstdin is set and standard
+ * input reaches end of file or hangs up while waiting, or on poll() error
+ */
+static int dry_wait(int fd, int watchstdin) {
+  struct pollfd pfd[2] = {{.fd = fd, .events = POLLIN}, {.fd = STDIN_FILENO, .events = POLLIN}};
+  char c;
+
+  for(;;) {
+    if(poll(pfd, watchstdin? 2: 1, -1) < 0) {
+      if(errno == EINTR)
+        continue;
+      pmsg_ext_error("poll(): %s\n", strerror(errno));
+      return -1;
+    }
+    if(watchstdin && pfd[1].revents && read(STDIN_FILENO, &c, 1) <= 0)
+      return -1;                // Any data on standard input are ignored
+    if(pfd[0].revents)
+      return 0;
+  }
+}
+
+// Return next byte from client or -1 if the connection was closed
+static int dry_getc(Dry_link *l) {
+  if(l->inhead >= l->inlen) {
+    ssize_t n;
+
+    if(dry_wait(l->fd, l->watchstdin) < 0) {
+      l->quit = 1;
+      return -1;
+    }
+    do
+      n = read(l->fd, l->in, sizeof l->in);
+    while(n < 0 && errno == EINTR);
+    if(n <= 0)
+      return -1;
+    l->inhead = 0;
+    l->inlen = n;
+  }
+  l->nio++;
+
+  return l->in[l->inhead++];
+}
+
+// Read the end-of-parameter byte: returns 1 if it is there, 0 if not and -1 on closed connection
+static int dry_eop(Dry_link *l) {
+  int c = dry_getc(l);
+
+  return c < 0? -1: c == Sync_CRC_EOP;
+}
+
+static void dry_put(Dry_link *l, int c) {
+  if(l->outlen < (int) sizeof l->out)
+    l->out[l->outlen++] = c;
+}
+
+// Send the pending output to the client
+static int dry_send(Dry_link *l) {
+  for(int n, sent = 0; sent < l->outlen; sent += n)
+    if((n = write(l->fd, l->out + sent, l->outlen - sent)) < 0) {
+      if(errno == EINTR) {
+        n = 0;
+        continue;
+      }
+      return -1;
+    }
+  l->outlen = 0;
+  l->nio = 0;
+
+  return 0;
+}
+
+// Send response after waiting as long as the emulated serial line would take for the command
+static int dry_reply(const PROGRAMMER *pgm, Dry_link *l) {
+  if(dry.baud > 0)
+    usleep((l->nio + l->outlen)*10e6/dry.baud);
+
+  return dry_send(l);
+}
+
+/*
+ * Receive (write) or send (read) len bytes of flash (mchr 'F') or EEPROM
+ * ('E') at byte address addr; the payload of writes is read from the client
+ * before the end-of-parameter byte, the contents of reads are put into the
+ * response. Returns 1 on success, 0 on protocol error and -1 on closed link.
+ */
+static int dry_page(const PROGRAMMER *pgm, const AVRPART *p, Dry_link *l, int write,
+  int mchr, unsigned int addr, int len) {
+
+  AVRMEM *m = mchr == 'F'? avr_locate_flash(p): mchr == 'E'? avr_locate_eeprom(p): NULL;
+  int valid = m && len > 0 && len <= (int) sizeof l->out - 2 && addr + len <= (unsigned int) m->size;
+  int c, rc;
+
+  if(write)
+    for(int i = 0; i < len; i++) {
+      if((c = dry_getc(l)) < 0)
+        return -1;
+      if(valid)
+        m->buf[addr + i] = c;
+    }
+  if((rc = dry_eop(l)) <= 0)
+    return rc;
+  if(!valid) {
+    pmsg_warning("emulator ignores %s of %d bytes at 0x%04x of %c memory\n", write? "write": "read", len,
+      addr, mchr);
+    return 0;
+  }
+
+  if(write) {                   // Urboot bootloaders protect themselves
+    if(!(mchr == 'F' && dry.urboot && addr + len > (unsigned int) dry.bootstart))
+      pgm->paged_write(pgm, p, m, m->page_size, addr, len);
+  } else if(pgm->paged_load(pgm, p, m, m->page_size, addr, len) >= 0) {
+    for(int i = 0; i < len; i++)
+      dry_put(l, m->buf[addr + i]);
+  }
+
+  return 1;
+}
+
+// Serve STK500v1 requests like optiboot until the client closes the connection
+static void dry_stk500v1(const PROGRAMMER *pgm, const AVRPART *p, Dry_link *l) {
+  unsigned int addr = 0, ext = 0;
+  int cmd, a, b, c, d, rc;
+
+  while((cmd = dry_getc(l)) >= 0) {
+    rc = 1;
+    switch(cmd) {
+    case Cmnd_STK_GET_PARAMETER:
+      if((a = dry_getc(l)) < 0 || (rc = dry_eop(l)) <= 0)
+        break;
+      dry_put(l, Resp_STK_INSYNC);
+      switch(a) {               // Optiboot v8.3 answers 3 for all parameters but its version
+      case Parm_STK_SW_MAJOR:
+        dry_put(l, 8);
+        break;
+      case Parm_STK_SW_MINOR:
+        dry_put(l, 3);
+        break;
+      default:
+        dry_put(l, 3);
+      }
+      break;
+    case Cmnd_STK_SET_DEVICE:
+    case Cmnd_STK_SET_DEVICE_EXT:
+      for(int i = cmd == Cmnd_STK_SET_DEVICE? 20: 5; i > 0; i--)
+        if(dry_getc(l) < 0)
+          return;
+      if((rc = dry_eop(l)) > 0)
+        dry_put(l, Resp_STK_INSYNC);
+      break;
+    case Cmnd_STK_LOAD_ADDRESS:
+      if((a = dry_getc(l)) < 0 || (b = dry_getc(l)) < 0 || (rc = dry_eop(l)) <= 0)
+        break;
+      addr = ((ext << 16) | (b << 8) | a)*2;    // Word address for classic parts
+      dry_put(l, Resp_STK_INSYNC);
+      break;
+    case Cmnd_STK_UNIVERSAL:
+      if((a = dry_getc(l)) < 0 || (b = dry_getc(l)) < 0 || (c = dry_getc(l)) < 0 ||
+        (d = dry_getc(l)) < 0 || (rc = dry_eop(l)) <= 0)
+        break;
+      if(a == (Subc_STK_UNIVERSAL_LEXT >> 24))
+        ext = c;
+      else if(a == (Subc_STK_UNIVERSAL_CE >> 24) && b == (uint8_t) (Subc_STK_UNIVERSAL_CE >> 16))
+        pgm->chip_erase(pgm, p);
+      dry_put(l, Resp_STK_INSYNC);
+      dry_put(l, 0);
+      break;
+    case Cmnd_STK_PROG_PAGE:
+    case Cmnd_STK_READ_PAGE:
+      if((a = dry_getc(l)) < 0 || (b = dry_getc(l)) < 0 || (c = dry_getc(l)) < 0)
+        return;
+      dry_put(l, Resp_STK_INSYNC);
+      rc = dry_page(pgm, p, l, cmd == Cmnd_STK_PROG_PAGE, c, addr, (a << 8) | b);
+      break;
+    case Cmnd_STK_READ_SIGN:
+      if((rc = dry_eop(l)) <= 0)
+        break;
+      dry_put(l, Resp_STK_INSYNC);
+      for(int i = 0; i < 3; i++)
+        dry_put(l, p->signature[i]);
+      break;
+    case Cmnd_STK_CHIP_ERASE:
+      if((rc = dry_eop(l)) > 0) {
+        dry_put(l, Resp_STK_INSYNC);
+        pgm->chip_erase(pgm, p);
+      }
+      break;
+    default:                    // Get sync, enter/leave progmode and all else
+      if((rc = dry_eop(l)) > 0)
+        dry_put(l, Resp_STK_INSYNC);
+    }
+    if(rc < 0)
+      return;
+    if(rc == 0) {
+      l->outlen = 0;
+      dry_put(l, Resp_STK_NOSYNC);
+    } else {
+      dry_put(l, Resp_STK_OK);
+    }
+    if(dry_reply(pgm, l) < 0)
+      return;
+  }
+}
+
+// Serve urprotocol requests like an urboot bootloader until the client closes the connection
+static void dry_urprotocol(const PROGRAMMER *pgm, const AVRPART *p, Dry_link *l) {
+  const AVRMEM *flm = avr_locate_flash(p);
+  const Avrintel *up = avr_locate_uP(p);
+  int mcuid = p->mcuid >= 0? p->mcuid: up? up->mcuid: 0;
+  int info = UB_INFO(UB_READ_FLASH | UB_CHIP_ERASE, mcuid);
+  int insync = info/255, ok = info%255, cmd, c, rc;
+
+  if(ok >= insync)              // The two protocol bytes differ
+    ok++;
+
+  while((cmd = dry_getc(l)) >= 0) {
+    rc = 1;
+    switch(cmd) {
+    case Cmnd_UR_PROG_PAGE_EE:
+    case Cmnd_UR_READ_PAGE_EE:
+    case Cmnd_UR_PROG_PAGE_FL:
+    case Cmnd_UR_READ_PAGE_FL: {
+      unsigned int addr = 0, len = 0;
+      int nab = flm->size > 0x10000? 3: 2, nlb = flm->page_size <= 256? 1: 2;
+
+      for(int i = 0; i < nab; i++) {    // Little endian byte address
+        if((c = dry_getc(l)) < 0)
+          return;
+        addr |= c << 8*i;
+      }
+      for(int i = 0; i < nlb; i++) {    // Big endian length
+        if((c = dry_getc(l)) < 0)
+          return;
+        len = len << 8 | c;
+      }
+      if(len == 0)
+        len = nlb == 1? 256: 65536;
+      dry_put(l, insync);
+      rc = dry_page(pgm, p, l, cmd == Cmnd_UR_PROG_PAGE_EE || cmd == Cmnd_UR_PROG_PAGE_FL,
+        cmd == Cmnd_UR_PROG_PAGE_FL || cmd == Cmnd_UR_READ_PAGE_FL? 'F': 'E', addr, len);
+      break;
+    }
+    case Cmnd_STK_CHIP_ERASE:
+      if((rc = dry_eop(l)) > 0) {
+        dry_put(l, insync);
+        pgm->chip_erase(pgm, p);
+      }
+      break;
+    default:                    // Get sync and all else
+      if((rc = dry_eop(l)) > 0)
+        dry_put(l, insync);
+    }
+    if(rc < 0)
+      return;
+    if(rc == 0)                 // Protocol error: a real bootloader would reset
+      l->outlen = 0;
+    else
+      dry_put(l, ok);
+    if(dry_reply(pgm, l) < 0)
+      return;
+  }
+}
+
+// Put an urboot table at the top of flash unless there is one already
+static void dry_urboot_table(const PROGRAMMER *pgm, const AVRPART *p) {
+  AVRMEM *flm = avr_locate_flash(dry.dp), *ee = avr_locate_eeprom(dry.dp);
+  unsigned char *top = flm->buf + flm->size - 6;
+  int ps = flm->page_size;
+
+  if(!dry.bootsize) {
+    dry.bootsize = (512 + ps - 1)/ps*ps;
+    dry.bootstart = flm->size - dry.bootsize;
+  }
+  if(top[5] >= 072 && top[5] <= 0147)   // Looks like urboot already
+    return;
+
+  top[0] = dry.bootsize/ps;     // Number of bootloader pages
+  top[1] = 0;                   // Not a vector bootloader
+  top[2] = 0x08;                // Ret opcode instead of rjmp to pgm_write_page()
+  top[3] = 0x95;
+  top[4] = (ee && ee->size > 0? UR_EEPROM: 0) | UR_PROTECTME;
+  top[5] = UR_VERSION;
+  sharedflash(pgm, flm, flm->size - 6, 6);
+}
+
+/*
+ * UPDI target emulator for -c dryrun -p <UPDI part> -x serve=...: answers a
+ * SerialUPDI host, eg, -c serialupdi -P <pty>, like a UPDI part wired to a
+ * USB-serial adapter with the usual resistor between RX and TX. Every byte
+ * is echoed as on the one-wire line, responses follow after the guard time
+ * set in CS CTRLA, and the data space is made up from the memories of the
+ * part. The NVM controller of the part's NVM version, which is derived from
+ * the part's memory layout, latches stores in a page buffer (versions 0, 3
+ * and 5) or writes directly under the current command (versions 2 and 4).
+ */
+
+#define DRY_NVMREGS 16          // Size of the emulated NVM controller register window
+
+typedef enum {
+  NV_NONE,
+  NV_WRITE,                     // Write page buffer or, with direct writes, each byte (NOR semantics)
+  NV_ERASEWRITE,                // Erase then write
+  NV_ERASE,                     // Erase page (flash) or bytes (other memories)
+  NV_BUFCLEAR,                  // Clear page buffer
+  NV_CHIPERASE,
+  NV_EEERASE,                   // Erase EEPROM
+  NV_FUSE,                      // Write fuse at NVMCTRL ADDR with NVMCTRL DATA (version 0)
+} Dry_nvmop;
+
+typedef struct {
+  uint32_t addr;
+  unsigned char val;
+} Dry_latch;
+
+typedef struct {
+  const AVRPART *p;
+  int nvmver;                   // NVM controller version '0', '2', '3', '4' or '5'
+  char sib[32 + 1];             // System information block
+  unsigned char cs[16];         // Control and status registers
+  unsigned char nvm[DRY_NVMREGS];       // NVM controller registers
+  int keys, sys;                // ASI_KEY_STATUS bits and ASI_SYS_STATUS bits bar LOCKSTATUS
+  int locked, inreset, disabled;
+  uint32_t ptr;                 // UPDI pointer
+  int repeat;                   // Repeat count of the next LD/ST *ptr instruction
+  Dry_nvmop mode;               // Current write command of NVM versions 2 and 4
+  Dry_latch *pb;                // Page buffer of NVM versions 0, 3 and 5
+  int npb, apb;
+  AVRMEM *last;                 // Memory of the last read
+  int nresp, nturn, sending;    // Response bytes and line turnarounds since the last flush
+} Dry_updi;
+
+#define dry_direct(u) ((u)->nvmver == '2' || (u)->nvmver == '4')
+#define dry_nvmstatus(u) ((u)->nvmver <= '2'? 2: 6)
+#define dry_nvmdata(u) ((u)->nvmver <= '2'? 6: 8)
+#define dry_nvmaddr(u) ((u)->nvmver <= '2'? 8: 12)
+
+/*
+ * NVM controller version from the memory layout of the part: tinyAVR and
+ * megaAVR parts (version 0) map flash below 0x800000; of the newer parts
+ * those with a paged EEPROM (AVR-EA/EB) latch writes in a page buffer and
+ * those with a bootrow (AVR-DU/EB) have the later controller revision.
+ */
+static int dry_nvmver(const AVRPART *p) {
+  const AVRMEM *flm = avr_locate_flash(p), *eem = avr_locate_eeprom(p);
+  int bootrow = avr_locate_bootrow(p) != NULL;
+
+  if(!flm || flm->offset < 0x800000)
+    return '0';
+
+  return eem && eem->page_size > 1? (bootrow? '5': '3'): bootrow? '4': '2';
+}
+
+static Dry_nvmop dry_nvmop(const Dry_updi *u, int cmd) {
+  switch(u->nvmver) {
+  case '0':
+    switch(cmd) {
+    case 1: return NV_WRITE;
+    case 2: return NV_ERASE;
+    case 3: return NV_ERASEWRITE;
+    case 4: return NV_BUFCLEAR;
+    case 5: return NV_CHIPERASE;
+    case 6: return NV_EEERASE;
+    case 7: return NV_FUSE;
+    }
+    break;
+  case '3':
+  case '5':
+    switch(cmd) {
+    case 0x04: case 0x14: return NV_WRITE;
+    case 0x05: case 0x15: return NV_ERASEWRITE;
+    case 0x08: case 0x17: return NV_ERASE;
+    case 0x0f: case 0x1f: return NV_BUFCLEAR;
+    case 0x20: return NV_CHIPERASE;
+    case 0x30: return NV_EEERASE;
+    }
+    break;
+  default:
+    switch(cmd) {
+    case 0x02: case 0x12: return NV_WRITE;
+    case 0x13: return NV_ERASEWRITE;
+    case 0x08: case 0x18: return NV_ERASE;
+    case 0x20: return NV_CHIPERASE;
+    case 0x30: return NV_EEERASE;
+    }
+  }
+
+  return NV_NONE;
+}
+
+// Is data space address addr in memory m?
+static int dry_in(const AVRMEM *m, uint32_t addr) {
+  return !mem_is_sib(m) && m->size > 0 && addr >= (uint32_t) m->offset &&
+    addr - (uint32_t) m->offset < (uint32_t) m->size;
+}
+
+static int dry_peek(const PROGRAMMER *pgm, Dry_updi *u, uint32_t addr) {
+  if(!u->last || !dry_in(u->last, addr)) {
+    LNODEID ln;
+
+    for(ln = lfirst(dry.dp->mem); ln && !dry_in(ldata(ln), addr); ln = lnext(ln))
+      continue;
+    if(!ln)
+      return 0;                 // Unmapped
+    u->last = ldata(ln);
+  }
+
+  return u->last->buf[addr - u->last->offset];
+}
+
+// Write val to all memories that contain addr, eg, fuses and fuse2
+static void dry_poke(const PROGRAMMER *pgm, uint32_t addr, int val) {
+  for(LNODEID ln = lfirst(dry.dp->mem); ln; ln = lnext(ln)) {
+    AVRMEM *m = ldata(ln);
+
+    if(dry_in(m, addr) && !mem_is_readonly(m))
+      m->buf[addr - m->offset] = val;
+  }
+}
+
+// Non-volatile memory that contains addr or NULL
+static AVRMEM *dry_nvmem(const PROGRAMMER *pgm, uint32_t addr) {
+  for(LNODEID ln = lfirst(dry.dp->mem); ln; ln = lnext(ln)) {
+    AVRMEM *m = ldata(ln);
+
+    if(dry_in(m, addr) && (mem_is_in_flash(m) || mem_is_eeprom(m) || mem_is_in_fuses(m) ||
+      mem_is_lock(m) || mem_is_user_type(m)))
+      return m;
+  }
+
+  return NULL;
+}
+
+/*
+ * Erase the flash page that contains addr or, for EEPROM-like memories, the
+ * byte at addr unless addr lies in [*startp, *startp + *np), the unit erased
+ * last, which is updated
+ */
+static void dry_erase(const PROGRAMMER *pgm, const Dry_updi *u, uint32_t addr, uint32_t *startp, int *np) {
+  AVRMEM *m;
+  int ps;
+
+  if((*np > 0 && addr - *startp < (uint32_t) *np) || !(m = dry_nvmem(pgm, addr)))
+    return;
+
+  ps = m->page_size;
+  if(ps > 1 && (mem_is_in_flash(m) || (mem_is_user_type(m) && u->nvmver != '0'))) {
+    *startp = m->offset + ((addr - m->offset) & ~(uint32_t) (ps - 1));
+    *np = ps;
+  } else {
+    *startp = addr;
+    *np = 1;
+  }
+  for(int i = 0; i < *np; i++)
+    dry_poke(pgm, *startp + i, 0xff);
+}
+
+// Whether the lock bits differ from their factory setting (stored little endian)
+static int dry_locked(const PROGRAMMER *pgm) {
+  AVRMEM *m = avr_locate_lock(dry.dp);
+
+  if(!m || m->initval == -1 || m->size <= 0 || m->size > (int) sizeof m->initval)
+    return 0;
+  for(int i = 0; i < m->size; i++)
+    if(m->buf[i] != (uint8_t) ((unsigned) m->initval >> 8*i))
+      return 1;
+
+  return 0;
+}
+
+static void dry_chiperase(const PROGRAMMER *pgm, Dry_updi *u) {
+  dryrun_chip_erase(pgm, u->p);
+  u->npb = 0;
+}
+
+// Execute NVM controller command cmd
+static void dry_nvmcommand(const PROGRAMMER *pgm, Dry_updi *u, int cmd) {
+  Dry_nvmop op = dry_nvmop(u, cmd);
+  uint32_t start = 0;
+  AVRMEM *ee;
+
+  pmsg_debug("UPDI emulator: NVM command 0x%02x\n", cmd);
+  switch(op) {
+  case NV_CHIPERASE:
+    dry_chiperase(pgm, u);
+    break;
+  case NV_EEERASE:
+    if((ee = avr_locate_eeprom(dry.dp)) && ee->size > 0)
+      memset(ee->buf, 0xff, ee->size);
+    break;
+  case NV_FUSE:
+    dry_poke(pgm, u->nvm[dry_nvmaddr(u)] | u->nvm[dry_nvmaddr(u) + 1] << 8, u->nvm[dry_nvmdata(u)]);
+    break;
+  default:
+    break;
+  }
+
+  if(dry_direct(u)) {           // Command applies to subsequent stores
+    u->mode = op;
+    return;
+  }
+
+  if(op == NV_ERASE || op == NV_ERASEWRITE)
+    for(int i = 0, n = 0; i < u->npb; i++)
+      dry_erase(pgm, u, u->pb[i].addr, &start, &n);
+  if(op == NV_WRITE || op == NV_ERASEWRITE)
+    for(int i = 0; i < u->npb; i++)
+      dry_poke(pgm, u->pb[i].addr, u->pb[i].val & (op == NV_WRITE? dry_peek(pgm, u, u->pb[i].addr): 0xff));
+  if(op != NV_NONE)
+    u->npb = 0;
+}
+
+// Store to non-volatile memory: goes to the page buffer or is written under the current command
+static void dry_nvmstore(const PROGRAMMER *pgm, Dry_updi *u, uint32_t addr, int val) {
+  if(!dry_direct(u)) {
+    if(u->npb == u->apb) {
+      u->apb = u->apb? 2*u->apb: 256;
+      u->pb = mmt_realloc(u->pb, u->apb*sizeof *u->pb);
+    }
+    u->pb[u->npb++] = (Dry_latch) { addr, val };
+    return;
+  }
+
+  switch(u->mode) {
+  case NV_WRITE:
+    dry_poke(pgm, addr, val & dry_peek(pgm, u, addr));
+    break;
+  case NV_ERASEWRITE:
+    dry_poke(pgm, addr, val);
+    break;
+  case NV_ERASE: {
+    uint32_t start = 0;
+    int n = 0;
+
+    dry_erase(pgm, u, addr, &start, &n);
+    break;
+  }
+  default:                      // Ignore stores without write command
+    break;
+  }
+}
+
+static int dry_load(const PROGRAMMER *pgm, Dry_updi *u, uint32_t addr) {
+  uint32_t r = addr - u->p->nvm_base;
+
+  if(r < DRY_NVMREGS)           // The emulated NVM controller is never busy
+    return r == (uint32_t) dry_nvmstatus(u)? 0: u->nvm[r];
+
+  return u->locked? 0: dry_peek(pgm, u, addr);
+}
+
+static void dry_store(const PROGRAMMER *pgm, Dry_updi *u, uint32_t addr, int val) {
+  uint32_t r = addr - u->p->nvm_base;
+  AVRMEM *m;
+
+  if(r < DRY_NVMREGS) {
+    u->nvm[r] = val;
+    if(r == 0)
+      dry_nvmcommand(pgm, u, val);
+  } else if((m = dry_nvmem(pgm, addr))) {
+    if(u->sys & (1 << UPDI_ASI_SYS_STATUS_UROWPROG)) {  // User row write of a locked part
+      if(mem_is_userrow(m))
+        dry_poke(pgm, addr, val);
+    } else if(!u->locked) {
+      dry_nvmstore(pgm, u, addr, val);
+    }
+  } else if(!u->locked) {
+    dry_poke(pgm, addr, val);
+  }
+}
+
+// Keys arrive in reverse byte order
+static void dry_key(const PROGRAMMER *pgm, Dry_updi *u, const unsigned char *rkey, int n) {
+  char key[8];
+
+  if(n != (int) sizeof key)
+    return;
+  for(int i = 0; i < n; i++)
+    key[i] = rkey[n - 1 - i];
+
+  if(!memcmp(key, UPDI_KEY_NVM, sizeof key))
+    u->keys |= 1 << UPDI_ASI_KEY_STATUS_NVMPROG;
+  else if(!memcmp(key, UPDI_KEY_CHIPERASE, sizeof key))
+    u->keys |= 1 << UPDI_ASI_KEY_STATUS_CHIPERASE;
+  else if(!memcmp(key, UPDI_KEY_UROW, sizeof key))
+    u->keys |= 1 << UPDI_ASI_KEY_STATUS_UROWWRITE;
+}
+
+static int dry_ldcs(const Dry_updi *u, int reg) {
+  switch(reg) {
+  case UPDI_ASI_KEY_STATUS:
+    return u->keys;
+  case UPDI_ASI_SYS_STATUS:
+    return u->sys | (u->locked << UPDI_ASI_SYS_STATUS_LOCKSTATUS);
+  }
+
+  return u->cs[reg];
+}
+
+static void dry_stcs(const PROGRAMMER *pgm, Dry_updi *u, int reg, int val) {
+  u->cs[reg] = val;
+  switch(reg) {
+  case UPDI_CS_CTRLB:
+    if(val & (1 << UPDI_CTRLB_UPDIDIS_BIT)) {   // Host leaves: part runs and UPDI sleeps until a break
+      u->disabled = 1;
+      u->keys = u->sys = 0;
+      u->locked = dry_locked(pgm);
+    }
+    break;
+  case UPDI_ASI_KEY_STATUS:     // Writing a one clears that key
+    u->keys &= ~val;
+    break;
+  case UPDI_ASI_RESET_REQ:
+    if(val == UPDI_RESET_REQ_VALUE) {
+      u->inreset = 1;
+      u->sys = 1 << UPDI_ASI_SYS_STATUS_RSTSYS;
+    } else if(u->inreset) {     // Release from reset acts on the keys
+      u->inreset = 0;
+      u->sys = 0;
+      if(u->keys & (1 << UPDI_ASI_KEY_STATUS_CHIPERASE)) {
+        dry_chiperase(pgm, u);
+        u->keys &= ~(1 << UPDI_ASI_KEY_STATUS_CHIPERASE);
+      }
+      u->locked = dry_locked(pgm);
+      if(u->keys & (1 << UPDI_ASI_KEY_STATUS_NVMPROG) && !u->locked)
+        u->sys |= 1 << UPDI_ASI_SYS_STATUS_NVMPROG;
+      if(u->keys & (1 << UPDI_ASI_KEY_STATUS_UROWWRITE))
+        u->sys |= 1 << UPDI_ASI_SYS_STATUS_UROWPROG;
+    }
+    break;
+  case UPDI_ASI_SYS_CTRLA:
+    if(val & (1 << UPDI_ASI_SYS_CTRLA_UROW_FINAL))
+      u->sys &= ~(1 << UPDI_ASI_SYS_STATUS_UROWPROG);
+    break;
+  }
+}
+
+/*
+ * Send echo and responses after the time the half-duplex line would take at
+ * -x baud=<n>: 12 bits per 8E2 frame plus the guard time on each turnaround
+ */
+static int dry_updi_flush(const PROGRAMMER *pgm, Dry_updi *u, Dry_link *l) {
+  if(dry.baud > 0)
+    usleep(((l->nio + u->nresp)*12 + u->nturn*(128 >> (u->cs[UPDI_CS_CTRLA] & 7)))*1e6/dry.baud);
+  u->nresp = u->nturn = 0;
+
+  return dry_send(l);
+}
+
+// Next byte from the host, echoed; pending output is sent before waiting for input
+static int dry_updi_getc(const PROGRAMMER *pgm, Dry_updi *u, Dry_link *l) {
+  int c;
+
+  if(l->inhead >= l->inlen || l->outlen >= (int) sizeof l->out)
+    if(dry_updi_flush(pgm, u, l) < 0)
+      return -1;
+  if((c = dry_getc(l)) >= 0) {
+    dry_put(l, c);
+    u->sending = 0;
+  }
+
+  return c;
+}
+
+// Little endian value of n bytes from the host
+static int dry_updi_getn(const PROGRAMMER *pgm, Dry_updi *u, Dry_link *l, int n, uint32_t *valp) {
+  int c;
+
+  *valp = 0;
+  for(int i = 0; i < n; i++) {
+    if((c = dry_updi_getc(pgm, u, l)) < 0)
+      return -1;
+    *valp |= (uint32_t) c << 8*i;
+  }
+
+  return 0;
+}
+
+static void dry_updi_put(const PROGRAMMER *pgm, Dry_updi *u, Dry_link *l, int c) {
+  if(l->outlen >= (int) sizeof l->out)
+    dry_updi_flush(pgm, u, l);
+  if(!u->sending) {
+    u->sending = 1;
+    u->nturn++;
+  }
+  u->nresp++;
+  dry_put(l, c);
+}
+
+// Execute the UPDI instruction with opcode op; returns -1 if the client closed the connection
+static int dry_updi_insn(const PROGRAMMER *pgm, Dry_updi *u, Dry_link *l, int op) {
+  int asize = ((op >> 2) & 3) + 1, dsize = (op & 3) + 1, ack = !(u->cs[UPDI_CS_CTRLA] & 0x08); // RSD
+  int ptrmode = (op >> 2) & 3, n, c;
+  unsigned char key[64];
+  uint32_t addr, val;
+
+  switch(op & 0xe0) {
+  case UPDI_LDS:
+    if(dry_updi_getn(pgm, u, l, asize, &addr) < 0)
+      return -1;
+    for(int i = 0; i < dsize; i++)
+      dry_updi_put(pgm, u, l, dry_load(pgm, u, addr + i));
+    break;
+  case UPDI_STS:
+    if(dry_updi_getn(pgm, u, l, asize, &addr) < 0)
+      return -1;
+    if(ack)
+      dry_updi_put(pgm, u, l, UPDI_PHY_ACK);
+    if(dry_updi_getn(pgm, u, l, dsize, &val) < 0)
+      return -1;
+    for(int i = 0; i < dsize; i++)
+      dry_store(pgm, u, addr + i, (val >> 8*i) & 0xff);
+    if(ack)
+      dry_updi_put(pgm, u, l, UPDI_PHY_ACK);
+    break;
+  case UPDI_LD:
+    if(ptrmode == 2) {
+      for(int i = 0; i < dsize; i++)
+        dry_updi_put(pgm, u, l, (u->ptr >> 8*i) & 0xff);
+      break;
+    }
+    for(n = u->repeat + 1, u->repeat = 0; n > 0; n--) {
+      for(int i = 0; i < dsize; i++)
+        dry_updi_put(pgm, u, l, dry_load(pgm, u, u->ptr + i));
+      if(op & UPDI_PTR_INC)
+        u->ptr += dsize;
+    }
+    break;
+  case UPDI_ST:
+    if(ptrmode == 2) {          // Data size is the size of the new pointer value
+      if(dry_updi_getn(pgm, u, l, dsize, &u->ptr) < 0)
+        return -1;
+      if(ack)
+        dry_updi_put(pgm, u, l, UPDI_PHY_ACK);
+      break;
+    }
+    for(n = u->repeat + 1, u->repeat = 0; n > 0; n--) {
+      if(dry_updi_getn(pgm, u, l, dsize, &val) < 0)
+        return -1;
+      for(int i = 0; i < dsize; i++)
+        dry_store(pgm, u, u->ptr + i, (val >> 8*i) & 0xff);
+      if(op & UPDI_PTR_INC)
+        u->ptr += dsize;
+      if(ack)
+        dry_updi_put(pgm, u, l, UPDI_PHY_ACK);
+    }
+    break;
+  case UPDI_LDCS:
+    dry_updi_put(pgm, u, l, dry_ldcs(u, op & 0x0f));
+    break;
+  case UPDI_STCS:
+    if((c = dry_updi_getc(pgm, u, l)) < 0)
+      return -1;
+    dry_stcs(pgm, u, op & 0x0f, c);
+    break;
+  case UPDI_REPEAT:
+    if(dry_updi_getn(pgm, u, l, dsize, &val) < 0)
+      return -1;
+    u->repeat = val;
+    break;
+  case UPDI_KEY:
+    n = 8 << (op & 3);
+    if(op & UPDI_KEY_SIB) {
+      for(int i = 0; i < n; i++)
+        dry_updi_put(pgm, u, l, i < (int) sizeof u->sib - 1? u->sib[i]: 0);
+      break;
+    }
+    for(int i = 0; i < n; i++) {
+      if((c = dry_updi_getc(pgm, u, l)) < 0)
+        return -1;
+      key[i] = c;
+    }
+    dry_key(pgm, u, key, n);
+    break;
+  }
+
+  return 0;
+}
+
+// Serve a SerialUPDI host until it closes the connection
+static void dry_updi(const PROGRAMMER *pgm, const AVRPART *p, Dry_link *l) {
+  Dry_updi *u = mmt_malloc(sizeof *u);
+  const char *family = p->family_id && *p->family_id? p->family_id: "AVR";
+  int c;
+
+  u->p = p;
+  u->nvmver = dry_nvmver(p);
+  snprintf(u->sib, sizeof u->sib, "%-8.8sP:%cD:%c-3M2 (DRYRUN.0)", family, u->nvmver,
+    u->nvmver == '0'? '0': '1');
+  u->cs[UPDI_CS_STATUSA] = 0x30;        // UPDI revision 3
+  u->locked = dry_locked(pgm);
+  pmsg_notice("UPDI emulator with NVM controller version %c\n", u->nvmver);
+
+  while((c = dry_updi_getc(pgm, u, l)) >= 0) {
+    if(c == UPDI_BREAK) {       // Break resets the UPDI link but not the part
+      u->cs[UPDI_CS_CTRLA] = u->cs[UPDI_CS_CTRLB] = 0;
+      u->repeat = u->disabled = 0;
+      continue;
+    }
+    if(u->disabled || c != UPDI_PHY_SYNC)       // Out of sync: wait for the next SYNC
+      continue;
+    if((c = dry_updi_getc(pgm, u, l)) < 0 || dry_updi_insn(pgm, u, l, c) < 0)
+      break;
+  }
+  mmt_free(u->pb);
+  mmt_free(u);
+}
+
+static const char *dry_target(const PROGRAMMER *pgm) {
+  return !dry.bl? "UPDI target": dry.urboot? "urboot": "optiboot";
+}
+
+// Open the server side of -x serve=net:[<host>:]<port> or -x serve=pty
+static int dry_listen(const PROGRAMMER *pgm, int *ptyp, int *sfdp) {
+  *sfdp = -1;
+  if(str_eq(dry.serve, "pty")) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY), sfd;
+    const char *name;
+    struct termios tio;
+
+    if(fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0 || !(name = ptsname(fd))) {
+      pmsg_ext_error("cannot open pseudo terminal: %s\n", strerror(errno));
+      return -1;
+    }
+    // Keep the slave side open, so the emulator survives clients coming and going
+    if((*sfdp = sfd = open(name, O_RDWR | O_NOCTTY)) >= 0 && tcgetattr(sfd, &tio) == 0) {
+      cfmakeraw(&tio);
+      tcsetattr(sfd, TCSANOW, &tio);
+    }
+    pmsg_info("emulating %s %s on -P %s\n", dry_target(pgm), dry.dp->desc, name);
+    *ptyp = 1;
+    return fd;
+  }
+
+  if(!str_starts(dry.serve, "net:")) {
+    pmsg_error("-x serve=%s must be net:[<host>:]<port> or pty\n", dry.serve);
+    return -1;
+  }
+
+  char *host = mmt_strdup(dry.serve + 4), *port = strrchr(host, ':');
+  struct addrinfo hints, *result, *rp;
+  int fd = -1, on = 1, s;
+
+  if(port)
+    *port++ = 0;
+  memset(&hints, 0, sizeof hints);
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  if((s = getaddrinfo(port? host: NULL, port? port: host, &hints, &result))) {
+    pmsg_error("cannot resolve %s: %s\n", dry.serve, gai_strerror(s));
+    mmt_free(host);
+    return -1;
+  }
+  for(rp = result; rp; rp = rp->ai_next) {
+    if((fd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol)) < 0)
+      continue;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on);
+    if(bind(fd, rp->ai_addr, rp->ai_addrlen) == 0 && listen(fd, 1) == 0)
+      break;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(result);
+  mmt_free(host);
+  if(fd < 0)
+    pmsg_ext_error("cannot listen on %s: %s\n", dry.serve, strerror(errno));
+  else
+    pmsg_info("emulating %s %s on -P %s\n", dry_target(pgm), dry.dp->desc, dry.serve);
+  *ptyp = 0;
+
+  return fd;
+}
+
+/*
+ * Serve one client after the other. If standard input is a pipe, shut down
+ * cleanly and return 0 once it is closed or hangs up; otherwise only return
+ * on error.
+ */
+static int dryrun_serve(const PROGRAMMER *pgm, const AVRPART *p) {
+  int fd, pty, sfd, watchstdin, rc = 0;
+  struct stat st;
+
+  int updi = !dry.bl && is_updi(p);
+
+  if(!updi && (dry.bl != DRY_TOP || !is_classic(p) || !avr_locate_flash(p)))
+    Return("-x serve needs -c dryrun and a UPDI part or -c dryboot and a classic part with flash");
+  if(dry.urboot && !updi)
+    dry_urboot_table(pgm, p);
+  if((fd = dry_listen(pgm, &pty, &sfd)) < 0)
+    return -1;
+  watchstdin = fstat(STDIN_FILENO, &st) == 0 && (S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode));
+
+  for(int quit = 0; !quit; ) {
+    Dry_link *l = mmt_malloc(sizeof *l);
+
+    l->watchstdin = watchstdin;
+    if(pty) {
+      l->fd = fd;
+    } else {
+      int on = 1;
+
+      if(dry_wait(fd, watchstdin) < 0) {
+        mmt_free(l);
+        break;
+      }
+      do
+        l->fd = accept(fd, NULL, NULL);
+      while(l->fd < 0 && errno == EINTR);
+      if(l->fd < 0) {
+        pmsg_ext_error("cannot accept connection: %s\n", strerror(errno));
+        mmt_free(l);
+        rc = -1;
+        break;
+      }
+      setsockopt(l->fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+      pmsg_notice("client connected\n");
+    }
+    (updi? dry_updi: dry.urboot? dry_urprotocol: dry_stk500v1) (pgm, p, l);
+    quit = l->quit;
+    if(!pty) {
+      close(l->fd);
+      pmsg_notice("client disconnected\n");
+    } else if(!quit) {
+      usleep(10000);            // Avoid spinning should the pseudo terminal report errors
+    }
+    mmt_free(l);
+  }
+
+  if(sfd >= 0)
+    close(sfd);
+  close(fd);
+  if(rc == 0)
+    pmsg_notice("standard input closed, emulator shut down\n");
+
+  return rc;
+}
+
+#else
+
+static int dryrun_serve(const PROGRAMMER *pgm, const AVRPART *p) {
+  Return("-x serve is not supported on Windows");
+}
+#endif
+
 // Initialise the AVR device and prepare it to accept commands
 static int dryrun_initialize(const PROGRAMMER *pgm, const AVRPART *p) {
   pmsg_debug("%s()\n", __func__);
@@ -714,6 +1766,9 @@ static int dryrun_initialize(const PROGRAMMER *pgm, const AVRPART *p) {
  *
  */
 
+  if(dry.serve)
+    return dryrun_serve(pgm, p);
+
   return pgm->program_enable(pgm, p);
 }
 
@@ -729,12 +1784,16 @@ static void dryrun_disable(const PROGRAMMER *pgm) {
 
 static int dryrun_open(PROGRAMMER *pgm, const char *port) {
   pmsg_debug("%s(%s)\n", __func__, port? port: "NULL");
+  dry.t_wall = avr_ustimestamp();
 
   return 0;
 }
 
 static void dryrun_close(PROGRAMMER *pgm) {
   pmsg_debug("%s()\n", __func__);
+  if(dry.timing)
+    pmsg_info("simulated time %.3f s (%d baud, %d us latency) vs wall time %.3f s\n",
+      dry.t_host/1e6, dry.baud, dry.latency, (avr_ustimestamp() - dry.t_wall)/1e6);
 }
 
 // Emulate flash NOR-memory
@@ -829,6 +1888,79 @@ static int dryrun_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AVRM
   return n_bytes;
 }
 
+// Pipelined paged load: requests are only counted, the memory is copied on collection
+static int dryrun_paged_load_async(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  pmsg_debug("%s(%s, %u, 0x%04x, %u)\n", __func__, m->desc, page_size, addr, n_bytes);
+  if(dry.readwindow < 2)
+    return LIBAVRDUDE_NOTSUPPORTED;
+  if(dry.rq_n >= dry.readwindow)
+    return LIBAVRDUDE_SOFTFAIL;
+  if(!dry.rq_done)
+    dry.rq_done = mmt_malloc(dry.readwindow*sizeof *dry.rq_done);
+  dry.rq_done[(dry.rq_head + dry.rq_n++)%dry.readwindow] = dry_issue(pgm, 0, n_bytes, 0);
+
+  return 0;
+}
+
+static int dryrun_paged_load_collect(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  pmsg_debug("%s(%s, %u, 0x%04x, %u)\n", __func__, m->desc, page_size, addr, n_bytes);
+  if(dry.rq_n < 1)
+    Return("no pipelined paged read in flight");
+  dry_collect(pgm, dry.rq_done[dry.rq_head]);
+  dry.rq_head = (dry.rq_head + 1)%dry.readwindow;
+  dry.rq_n--;
+
+  return dryrun_paged_load(pgm, p, m, page_size, addr, n_bytes);
+}
+
+// Pipelined paged write: requests are only counted, the page is written on collection
+static int dryrun_paged_write_async(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  pmsg_debug("%s(%s, %u, 0x%04x, %u)\n", __func__, m->desc, page_size, addr, n_bytes);
+  if(dry.writewindow < 2)
+    return LIBAVRDUDE_NOTSUPPORTED;
+  if(dry.wq_n >= dry.writewindow)
+    return LIBAVRDUDE_SOFTFAIL;
+  if(!dry.wq_done)
+    dry.wq_done = mmt_malloc(dry.writewindow*sizeof *dry.wq_done);
+  dry.wq_done[(dry.wq_head + dry.wq_n++)%dry.writewindow] = dry_issue(pgm, n_bytes, 0, dry_busy(m));
+
+  return 0;
+}
+
+static int dryrun_paged_write_collect(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  pmsg_debug("%s(%s, %u, 0x%04x, %u)\n", __func__, m->desc, page_size, addr, n_bytes);
+  if(dry.wq_n < 1)
+    Return("no pipelined paged write in flight");
+  dry_collect(pgm, dry.wq_done[dry.wq_head]);
+  dry.wq_head = (dry.wq_head + 1)%dry.writewindow;
+  dry.wq_n--;
+
+  return dryrun_paged_write(pgm, p, m, page_size, addr, n_bytes);
+}
+
+// Synchronous paged access accounts for the simulated time of a round trip
+static int dryrun_sync_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  dry_command(pgm, n_bytes, n_bytes? dry_busy(m): 0);
+  return dryrun_paged_write(pgm, p, m, page_size, addr, n_bytes);
+}
+
+static int dryrun_sync_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  dry_command(pgm, n_bytes, 0);
+  return dryrun_paged_load(pgm, p, m, page_size, addr, n_bytes);
+}
+
 int dryrun_write_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
   unsigned long addr, unsigned char data) {
 
@@ -837,6 +1969,7 @@ int dryrun_write_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
   pmsg_debug("%s(%s, 0x%04lx, 0x%02x)\n", __func__, m->desc, addr, data);
   if(!dry.dp)
     Return("no dryrun device?");
+  dry_command(pgm, 1, dry_busy(m));
   if(!(dmem = avr_locate_mem(dry.dp, m->desc)))
     Return("cannot locate %s %s memory for bytewise write", dry.dp->desc, m->desc);
   if(dmem->size < 1)
@@ -893,6 +2026,7 @@ int dryrun_read_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
   pmsg_debug("%s(%s, 0x%04lx)", __func__, m->desc, addr);
   if(!dry.dp)
     Return("no dryrun device?");
+  dry_command(pgm, 1, 0);
   if(!(dmem = avr_locate_mem(dry.dp, m->desc)))
     Return("cannot locate %s %s memory for bytewise read", dry.dp->desc, m->desc);
   if(dmem->size < 1)
@@ -976,6 +2110,9 @@ static void dryrun_setup(PROGRAMMER *pgm) {
 
 static void dryrun_teardown(PROGRAMMER *pgm) {
   pmsg_debug("%s()\n", __func__);
+  mmt_free(dry.rq_done);
+  mmt_free(dry.wq_done);
+  mmt_free(dry.serve);
   mmt_free(pgm->cookie);
   pgm->cookie = NULL;
 }
@@ -1011,6 +2148,52 @@ static int dryrun_parseextparams(const PROGRAMMER *pgm, const LISTID extparms) {
         dry.random = 1;
       continue;
     }
+    if(str_starts(xpara, "readwindow=") || str_starts(xpara, "writewindow=")) {
+      const char *errptr;
+      int n = str_int(strchr(xpara, '=') + 1, STR_INT32, &errptr);
+
+      if(errptr || n < 1) {
+        pmsg_error("cannot parse %s value: %s\n", xpara, errptr? errptr: "must be positive");
+        rc = -1;
+        break;
+      }
+      if(*xpara == 'r')
+        dry.readwindow = n;
+      else
+        dry.writewindow = n;
+      continue;
+    }
+    if(str_starts(xpara, "serve=")) {
+      mmt_free(dry.serve);
+      dry.serve = mmt_strdup(xpara + 6);
+      continue;
+    }
+    if(str_eq(xpara, "urboot")) {
+      dry.urboot = 1;
+      continue;
+    }
+    if(str_eq(xpara, "timing")) {
+      dry.timing |= 1;
+      continue;
+    }
+    if(str_starts(xpara, "baud=") || str_starts(xpara, "latency=")) {
+      const char *errptr;
+      int n = str_int(strchr(xpara, '=') + 1, STR_INT32, &errptr);
+
+      if(errptr || n < 0) {
+        pmsg_error("cannot parse %s value: %s\n", xpara, errptr? errptr: "must not be negative");
+        rc = -1;
+        break;
+      }
+      if(*xpara == 'b') {
+        dry.baud = n;
+        dry.timing |= 2;
+      } else {
+        dry.latency = n;
+        dry.timing |= 4;
+      }
+      continue;
+    }
     if(str_eq(xpara, "help")) {
       help = true;
       rc = LIBAVRDUDE_EXIT;
@@ -1026,14 +2209,31 @@ static int dryrun_parseextparams(const PROGRAMMER *pgm, const LISTID extparms) {
     msg_error("  -x random     Initialise memories with random code/values (1, 3)\n");
     msg_error("  -x random=<n> Shortcut for -x random -x seed=<n>\n");
     msg_error("  -x seed=<n>   Seed random number generator with <n>, n>0, default time(NULL)\n");
+    msg_error("  -x readwindow=<n> Pipeline paged reads with up to <n> requests in flight\n");
+    msg_error("  -x writewindow=<n> Pipeline paged writes with up to <n> pages in flight\n");
+    msg_error("  -x timing     Simulate programming time, default %d baud, %d us latency\n", DRY_BAUD, DRY_LATENCY);
+    msg_error("  -x baud=<n>   Simulate programming time for a link with <n> bit/s\n");
+    msg_error("  -x latency=<n> Simulate programming time with <n> us latency per command\n");
+    msg_error("  -x serve=net:<port> Emulate optiboot or a UPDI target for clients on TCP <port> (4)\n");
+    msg_error("  -x serve=pty  Emulate optiboot or a UPDI target on a new pseudo terminal (4)\n");
+    msg_error("  -x urboot     Emulate an urboot bootloader instead of optiboot\n");
     msg_error("  -x help       Show this help menu and exit\n");
     msg_error("Notes:\n");
     msg_error("  (1) -x init and -x random randomly configure flash wrt boot/data/code length\n");
     msg_error("  (2) Patterns can best be seen with fixed-width font on -U flash:r:-:I\n");
     msg_error("  (3) Choose, eg, -x seed=1 for reproducible flash configuration and output\n");
+    msg_error("  (4) Needs -c dryboot or a UPDI part; -x baud=<n> throttles replies to a serial line of <n> baud\n");
+    msg_error("      Serves clients until interrupted or until its standard input, if a pipe, is closed\n");
     return rc;
   }
 
+  if(dry.timing) {              // Use defaults for link parameters not set explicitly
+    if(!(dry.timing & 2))
+      dry.baud = DRY_BAUD;
+    if(!(dry.timing & 4))
+      dry.latency = DRY_LATENCY;
+  }
+
   return rc;
 }
 
@@ -1064,8 +2264,12 @@ void dryrun_initpgm(PROGRAMMER *pgm) {
   pgm->write_byte = dryrun_write_byte;
 
   // Optional functions
-  pgm->paged_write = dryrun_paged_write;
-  pgm->paged_load = dryrun_paged_load;
+  pgm->paged_write = dryrun_sync_paged_write;
+  pgm->paged_load = dryrun_sync_paged_load;
+  pgm->paged_load_async = dryrun_paged_load_async;
+  pgm->paged_load_collect = dryrun_paged_load_collect;
+  pgm->paged_write_async = dryrun_paged_write_async;
+  pgm->paged_write_collect = dryrun_paged_write_collect;
   pgm->setup = dryrun_setup;
   pgm->teardown = dryrun_teardown;
   pgm->term_keep_alive = dryrun_term_keep_alive;
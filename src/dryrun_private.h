@@ -23,10 +23,14 @@
 
 #define Resp_STK_OK             0x10
 #define Resp_STK_INSYNC         0x14
+#define Resp_STK_NOSYNC         0x15
 
 #define Sync_CRC_EOP            0x20
 
 #define Cmnd_STK_GET_SYNC       0x30
+#define Cmnd_STK_GET_PARAMETER  0x41
+#define Cmnd_STK_SET_DEVICE     0x42
+#define Cmnd_STK_SET_DEVICE_EXT 0x45
 #define Cmnd_STK_ENTER_PROGMODE 0x50
 #define Cmnd_STK_LEAVE_PROGMODE 0x51
 #define Cmnd_STK_CHIP_ERASE     0x52
@@ -37,6 +41,27 @@
 #define Cmnd_STK_READ_PAGE      0x74
 #define Cmnd_STK_READ_SIGN      0x75
 
+#define Parm_STK_HW_VER         0x80
+#define Parm_STK_SW_MAJOR       0x81
+#define Parm_STK_SW_MINOR       0x82
+
+// Urprotocol command extensions to STK500v1
+#define Cmnd_UR_PROG_PAGE_EE    0x00
+#define Cmnd_UR_READ_PAGE_EE    0x01
+#define Cmnd_UR_PROG_PAGE_FL    0x02
+#define Cmnd_UR_READ_PAGE_FL    0x03
+
+// Urprotocol side channel info about MCU id and bootloader features (see urclock_private.h)
+#define UB_N_MCU                2040
+#define UB_READ_FLASH              4    // Bootloader can read flash
+#define UB_CHIP_ERASE             16    // Bootloader has a flash-only chip erase
+#define UB_INFO(ub_features, ub_mcuid) ((ub_features)*UB_N_MCU + (ub_mcuid))
+
+// Urboot capability byte and version at the top of flash
+#define UR_EEPROM                 64    // EEPROM read/write support
+#define UR_PROTECTME               2    // Bootloader safeguards against overwriting itself
+#define UR_VERSION              0100    // Urboot v8.0
+
 // STK_UNIVERSAL commands
 #define Subc_STK_UNIVERSAL_LEXT 0x4d000000u     // Load extended address
 #define Subc_STK_UNIVERSAL_CE   0xac800000u     // Chip erase
@@ -26,6 +26,8 @@
 #include <errno.h>
 #include <ctype.h>
 #include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #ifdef HAVE_LIBELF
 
@@ -270,28 +272,100 @@ typedef enum {
   LAST_SEG = 2,
 } Segorder;
 
-static void print_ihex_extended_addr(int n_64k, FILE *outf) {
+// Output buffer for the .hex/.srec writers, set up once per file and flushed to it in blocks
+#define HEXOUT_SIZE 65536
+
+typedef struct {
+  FILE *f;
+  size_t n;
+  char *buf;
+  int err;                      // Writing to the file failed
+} Hexout;
+
+static void hexo_open(Hexout *o, FILE *f) {
+  o->f = f;
+  o->n = 0;
+  o->buf = mmt_malloc(HEXOUT_SIZE);
+  o->err = 0;
+}
+
+static void hexo_flush(Hexout *o) {
+  if(o->n && !o->err && fwrite(o->buf, 1, o->n, o->f) != o->n) {
+    pmsg_ext_error("unable to write file: %s\n", strerror(errno));
+    o->err = 1;
+  }
+  o->n = 0;
+}
+
+// Flush and free the buffer; return -1 if writing to the file failed
+static int hexo_close(Hexout *o) {
+  hexo_flush(o);
+  mmt_free(o->buf);
+  o->buf = NULL;
+
+  return o->err? -1: 0;
+}
+
+static void hexo_putc(Hexout *o, int c) {
+  if(o->n == HEXOUT_SIZE)
+    hexo_flush(o);
+  o->buf[o->n++] = c;
+}
+
+static void hexo_puts(Hexout *o, const char *s) {
+  while(*s)
+    hexo_putc(o, *s++);
+}
+
+// Hex byte in upper case as "%02X" would do
+static void hexo_byte(Hexout *o, unsigned char b) {
+  static const char hex[] = "0123456789ABCDEF";
+
+  if(o->n + 2 > HEXOUT_SIZE)
+    hexo_flush(o);
+  o->buf[o->n++] = hex[b >> 4];
+  o->buf[o->n++] = hex[b & 15];
+}
+
+// Hex number with at least width digits as "%0*X" (upper) or "%0*x" (lower case) would do
+static void hexo_num(Hexout *o, unsigned v, int width, int upper) {
+  const char *hex = upper? "0123456789ABCDEF": "0123456789abcdef";
+  int nd = 1;
+
+  while(nd < 8 && v >> 4*nd)
+    nd++;
+  if(nd < width)
+    nd = width;
+  while(nd-- > 0)
+    hexo_putc(o, nd < 8? hex[(v >> 4*nd) & 15]: '0');
+}
+
+static void print_ihex_extended_addr(int n_64k, Hexout *o) {
   unsigned char hi = (n_64k >> 8);
   unsigned char lo = n_64k;
   unsigned char cksum = -(2 + 0 + 4 + hi + lo);
 
-  fprintf(outf, ":02000004%02X%02X%02X\n", hi, lo, cksum);
+  hexo_puts(o, ":02000004");
+  hexo_byte(o, hi);
+  hexo_byte(o, lo);
+  hexo_byte(o, cksum);
+  hexo_putc(o, '\n');
 }
 
 /*
  * Binary buffer to Intel Hex, see https://en.wikipedia.org/wiki/Intel_HEX
  *
- * Given a buffer and a single segment, segp, an open file 'outf' to which to
- * write Intel Hex formatted data, the desired record size recsize, an
- * AVR32-specific memory offset startaddr and the name of the output file,
- * write a valid Intel Hex file. Where indicates whether this is the first
+ * Given a buffer and a single segment, segp, the output buffer 'o' of a file
+ * to which to write Intel Hex formatted data, the desired record size
+ * recsize, an AVR32-specific memory offset startaddr and the name of the
+ * output file, write a valid Intel Hex file. Where indicates whether this is the first
  * segment to be written to the file or the last segment (or both).
  *
  * Return the maximum memory address within mem->buf that was read from plus
  * one. If an error occurs, return -1.
  */
 static int b2ihex(const AVRPART *p, const AVRMEM *mem, const Segment *segp, Segorder where,
-  int recsize, int startaddr, const char *outfile_unused, FILE *outf, FILEFMT ffmt) {
+  int recsize, int startaddr, const char *outfile_unused, Hexout *o, FILEFMT ffmt) {
 
   const unsigned char *buf = mem->buf;
   int bufsize = segp->len;
@@ -310,7 +384,7 @@ static int b2ihex(const AVRPART *p, const AVRMEM *mem, const Segment *segp, Sego
 
   // Give address unless it's the first segment and it would be the default 0
   if(!((where & FIRST_SEG) && n_64k == 0))
-    print_ihex_extended_addr(n_64k, outf);
+    print_ihex_extended_addr(n_64k, o);
 
   while(bufsize) {
     n = recsize;
@@ -321,38 +395,48 @@ static int b2ihex(const AVRPART *p, const AVRMEM *mem, const Segment *segp, Sego
       n = 0x10000 - nextaddr;
 
     if(n) {
-      fprintf(outf, ":%02X%04X00", n, nextaddr);
+      hexo_putc(o, ':');
+      hexo_byte(o, n);
+      hexo_num(o, nextaddr, 4, 1);
+      hexo_puts(o, "00");
       unsigned char c, cksum = n + ((nextaddr >> 8) & 0x0ff) + (nextaddr & 0x0ff);
 
       for(int i = 0; i < n; i++) {
-        fprintf(outf, "%02X", buf[i]);
+        hexo_byte(o, buf[i]);
         cksum += buf[i];
       }
       cksum = -cksum;
-      fprintf(outf, "%02X", cksum);
+      hexo_byte(o, cksum);
 
       if(ffmt == FMT_IHXC) {    // Print comment with address and ASCII dump
         const char *name = memlabel(p, mem, n_64k*0x10000 + nextaddr, n);
 
         for(int i = n; i < recsize; i++)
-          fprintf(outf, "  ");
-        fprintf(outf, " // %05x> ", n_64k*0x10000 + nextaddr);
+          hexo_puts(o, "  ");
+        hexo_puts(o, " // ");
+        hexo_num(o, n_64k*0x10000 + nextaddr, 5, 0);
+        hexo_puts(o, "> ");
         for(int i = 0; i < n; i++)
-          if(n < 9 && name)
-            fprintf(outf, "%s0x%02x", i? " ": "", buf[i]);
-          else
-            putc((c = buf[i] & 0x7f) < ' ' || c == 0x7f? '.': c, outf);
+          if(n < 9 && name) {
+            hexo_puts(o, i? " 0x": "0x");
+            hexo_num(o, buf[i], 2, 0);
+          } else
+            hexo_putc(o, (c = buf[i] & 0x7f) < ' ' || c == 0x7f? '.': c);
         if(name) {
-          fprintf(outf, " %s", name);
+          hexo_putc(o, ' ');
+          hexo_puts(o, name);
           if((str_eq(name, "sigrow") || str_eq(name, "signature")) && !nextaddr) {
             const char *mculist = str_ccmcunames_signature(buf, PM_ALL);
 
-            if(*mculist)
-              fprintf(outf, " (%s)", mculist);
+            if(*mculist) {
+              hexo_puts(o, " (");
+              hexo_puts(o, mculist);
+              hexo_putc(o, ')');
+            }
           }
         }
       }
-      putc('\n', outf);
+      hexo_putc(o, '\n');
 
       nextaddr += n;
       hiaddr += n;
@@ -361,7 +445,7 @@ static int b2ihex(const AVRPART *p, const AVRMEM *mem, const Segment *segp, Sego
     if(nextaddr >= 0x10000 && bufsize > n) {
       // Output an extended address record
       n_64k++;
-      print_ihex_extended_addr(n_64k, outf);
+      print_ihex_extended_addr(n_64k, o);
       nextaddr = 0;
     }
 
@@ -372,16 +456,128 @@ static int b2ihex(const AVRPART *p, const AVRMEM *mem, const Segment *segp, Sego
 
   // Add the end of record data line if it's the last segment
   if(where & LAST_SEG)
-    fprintf(outf, ":00000001FF\n");
+    hexo_puts(o, ":00000001FF\n");
+
+  return o->err? -1: hiaddr;
+}
+
+// Value of hex digits 0-9, A-F and a-f; 0xff for all other characters
+static const unsigned char hexval[256] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+/*
+ * Convert the n characters at s to a number in *valp. Return -1 if they do
+ * not form a number. Pure hex digits are decoded via the table; anything
+ * else (blanks, signs, ...) is left to strtoull() so that the accepted
+ * input is the same as that of earlier versions.
+ */
+static int hexfield(const char *s, int n, unsigned long long *valp) {
+  unsigned long long v = 0;
+  int i;
+
+  for(i = 0; i < n && hexval[(unsigned char) s[i]] != 0xff; i++)
+    v = v << 4 | hexval[(unsigned char) s[i]];
+
+  if(i < n) {
+    char buf[20], *e;
+
+    memcpy(buf, s, n);
+    buf[n] = 0;
+    v = strtoull(buf, &e, 16);
+    if(e == buf || *e != 0)
+      return -1;
+  }
+  *valp = v;
 
-  return hiaddr;
+  return 0;
+}
+
+// Line reader for .hex/.srec files that reads in large blocks and does not allocate per line
+typedef struct {
+  FILE *f;
+  char *buf;
+  size_t size, beg, end;        // Buffer size and unread bytes buf[beg, end)
+  int eof;
+  const char *err;
+} Linereader;
+
+static void lr_open(Linereader *lr, FILE *f) {
+  memset(lr, 0, sizeof *lr);
+  lr->f = f;
+  lr->size = 65536;
+  lr->buf = mmt_malloc(lr->size + 1);
+}
+
+static void lr_close(Linereader *lr) {
+  mmt_free(lr->buf);
+  lr->buf = NULL;
+}
+
+// Return next line without its newline as string in the reader's buffer; NULL on EOF or error
+static char *lr_gets(Linereader *lr) {
+  char *nl;
+
+  while(!(nl = memchr(lr->buf + lr->beg, '\n', lr->end - lr->beg)) && !lr->eof) {
+    if(lr->beg) {               // Move partial line to front
+      memmove(lr->buf, lr->buf + lr->beg, lr->end - lr->beg);
+      lr->end -= lr->beg;
+      lr->beg = 0;
+    }
+    if(lr->end == lr->size) {   // Line fills buffer: grow
+      if(lr->size >= INT_MAX/2) {
+        lr->err = "cannot cope with lines longer than INT_MAX/2 bytes";
+        return NULL;
+      }
+      lr->size *= 2;
+      lr->buf = mmt_realloc(lr->buf, lr->size + 1);
+    }
+    size_t n = fread(lr->buf + lr->end, 1, lr->size - lr->end, lr->f);
+
+    lr->end += n;
+    if(n == 0) {
+      if(ferror(lr->f)) {
+        lr->err = "I/O error";
+        return NULL;
+      }
+      lr->eof = 1;
+    }
+  }
+
+  if(lr->beg == lr->end)
+    return NULL;
+
+  char *ret = lr->buf + lr->beg;
+
+  if(nl) {                      // Terminate line in place of the newline
+    *nl = 0;
+    lr->beg = nl + 1 - lr->buf;
+  } else {                      // Last line without newline; buf has room for the terminator
+    lr->buf[lr->end] = 0;
+    lr->beg = lr->end;
+  }
+
+  return ret;
 }
 
 static int ihex_readrec(struct ihexsrec *ihex, char *rec) {
-  int i, j;
-  char buf[8];
+  unsigned long long v;
   int offset, len;
-  char *e;
   unsigned char cksum;
 
   len = strlen(rec);
@@ -389,59 +585,38 @@ static int ihex_readrec(struct ihexsrec *ihex, char *rec) {
   cksum = 0;
 
   // Reclen
-  if(offset + 2 > len)
-    return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  ihex->reclen = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
+  if(offset + 2 > len || hexfield(rec + offset, 2, &v) < 0)
     return -1;
+  ihex->reclen = v;
+  offset += 2;
 
   // Load offset
-  if(offset + 4 > len)
-    return -1;
-  for(i = 0; i < 4; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  ihex->loadofs = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
+  if(offset + 4 > len || hexfield(rec + offset, 4, &v) < 0)
     return -1;
+  ihex->loadofs = v;
+  offset += 4;
 
   // Record type
-  if(offset + 2 > len)
-    return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  ihex->rectyp = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
+  if(offset + 2 > len || hexfield(rec + offset, 2, &v) < 0)
     return -1;
+  ihex->rectyp = v;
+  offset += 2;
 
   cksum = ihex->reclen + ((ihex->loadofs >> 8) & 0x0ff) + (ihex->loadofs & 0x0ff) + ihex->rectyp;
 
   // Data
-  for(j = 0; j < ihex->reclen; j++) {
-    if(offset + 2 > len)
-      return -1;
-    for(i = 0; i < 2; i++)
-      buf[i] = rec[offset++];
-    buf[i] = 0;
-    ihex->data[j] = strtoul(buf, &e, 16);
-    if(e == buf || *e != 0)
+  for(int j = 0; j < ihex->reclen; j++) {
+    if(offset + 2 > len || hexfield(rec + offset, 2, &v) < 0)
       return -1;
+    ihex->data[j] = v;
+    offset += 2;
     cksum += ihex->data[j];
   }
 
   // Cksum
-  if(offset + 2 > len)
-    return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  ihex->cksum = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
+  if(offset + 2 > len || hexfield(rec + offset, 2, &v) < 0)
     return -1;
+  ihex->cksum = v;
 
   pmsg_debug("read ihex record type 0x%02x at 0x%04x with %2d bytes and chksum 0x%02x (0x%02x)\n",
     ihex->rectyp, ihex->loadofs, ihex->reclen, ihex->cksum, -cksum & 0xff);
@@ -486,7 +661,7 @@ static int any2mem(const AVRPART *p, const AVRMEM *mem, const Segment *segp, con
 static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM *mem,
   const Segment *segp, unsigned int fileoffset, FILEFMT ffmt) {
 
-  const char *errstr;
+  Linereader lr;
   unsigned int nextaddr, baseaddr, maxaddr;
   int lineno, rc;
   struct ihexsrec ihex;
@@ -496,28 +671,23 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
   maxaddr = 0;
   nextaddr = 0;
   rewind(inf);
+  lr_open(&lr, inf);
 
   AVRMEM *any = fileio_any_memory("any");
 
-  for(char *buffer; (buffer = str_fgets(inf, &errstr)); mmt_free(buffer)) {
+  for(char *buffer; (buffer = lr_gets(&lr)); ) {
     lineno++;
-    int len = strlen(buffer);
-
-    if(len > 0 && buffer[len - 1] == '\n')
-      buffer[--len] = 0;
-    if(len == 0 || buffer[0] != ':')
+    if(buffer[0] != ':')
       continue;
     rc = ihex_readrec(&ihex, buffer);
     if(rc < 0) {
       pmsg_error("invalid record at line %d of %s\n", lineno, infile);
-      mmt_free(buffer);
       goto error;
     }
     if(rc != ihex.cksum) {
       if(ffmt == FMT_IHEX) {
         pmsg_error("checksum mismatch at line %d of %s\n", lineno, infile);
         imsg_error("checksum=0x%02x, computed checksum=0x%02x\n", ihex.cksum, rc);
-        mmt_free(buffer);
         goto error;
       }
       // Just warn with more permissive format FMT_IHXC
@@ -534,7 +704,6 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
           pmsg_error("address 0x%06x below memory offset 0x%x at line %d of %s;\n",
             ihex.loadofs + baseaddr, fileoffset, lineno, infile);
           imsg_error("use -F to skip this check\n");
-          mmt_free(buffer);
           goto error;
         }
         pmsg_warning("address 0x%06x below memory offset 0x%x at line %d of %s: ",
@@ -554,7 +723,6 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
           pmsg_error("Intel Hex record [0x%06x, 0x%06x] out of range [0, 0x%06x]\n",
             nextaddr, nextaddr + ihex.reclen - 1, anysize - 1);
           imsg_error("at line %d of %s; use -F to skip this check\n", lineno, infile);
-          mmt_free(buffer);
           goto error;
         }
         pmsg_warning("Intel Hex record [0x%06x, 0x%06x] out of range [0, 0x%06x]: ",
@@ -575,7 +743,6 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
           pmsg_error("signature of %s incompatible with file's (%s);\n", p->desc,
             str_ccmcunames_signature(any->buf + nextaddr, PM_ALL));
           imsg_error("use -F to override this check\n");
-          mmt_free(buffer);
           goto error;
         }
       if(ihex.reclen && nextaddr + ihex.reclen > maxaddr)
@@ -583,7 +750,6 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
       break;
 
     case 1:                    // End of file record
-      mmt_free(buffer);
       goto done;
 
     case 2:                    // Extended segment address record
@@ -604,13 +770,12 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
 
     default:
       pmsg_error("do not know how to deal with rectype=%d " "at line %d of %s\n", ihex.rectyp, lineno, infile);
-      mmt_free(buffer);
       goto error;
     }
   }
 
-  if(errstr) {
-    pmsg_error("read error in Intel Hex file %s: %s\n", infile, errstr);
+  if(lr.err) {
+    pmsg_error("read error in Intel Hex file %s: %s\n", infile, lr.err);
     goto error;
   }
 
@@ -622,6 +787,7 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
   pmsg_warning("no end of file record found for Intel Hex file %s\n", infile);
 
 done:
+  lr_close(&lr);
   rc = any2mem(p, mem, segp, any, maxaddr);
   avr_free_mem(any);
   if(!rc)
@@ -629,6 +795,7 @@ done:
   return rc;
 
 error:
+  lr_close(&lr);
   avr_free_mem(any);
   return -1;
 }
@@ -647,7 +814,7 @@ static unsigned int cksum_srec(const unsigned char *buf, int n, unsigned addr, i
 
 // Binary to Motorola S-Record, see https://en.wikipedia.org/wiki/SREC_(file_format)
 static int b2srec(const AVRMEM *mem, const Segment *segp, Segorder where,
-  int recsize, int startaddr, const char *outfile_unused, FILE *outf) {
+  int recsize, int startaddr, const char *outfile_unused, Hexout *o) {
 
   const unsigned char *buf;
   unsigned int nextaddr;
@@ -685,10 +852,13 @@ static int b2srec(const AVRMEM *mem, const Segment *segp, Segorder where,
     const char *s = "https://github.com/avrdudes/avrdude";
     unsigned char len = strlen(s);
 
-    fprintf(outf, "S0%02X0000", len + 3);
+    hexo_puts(o, "S0");
+    hexo_byte(o, len + 3);
+    hexo_puts(o, "0000");
     for(int i = 0; i < len; i++)
-      fprintf(outf, "%02X", s[i]);
-    fprintf(outf, "%02X\n", cksum_srec((unsigned char *) s, len, 0, 2));
+      hexo_byte(o, s[i]);
+    hexo_byte(o, cksum_srec((unsigned char *) s, len, 0, 2));
+    hexo_putc(o, '\n');
     cx->reccount = 0;
   }
 
@@ -697,10 +867,14 @@ static int b2srec(const AVRMEM *mem, const Segment *segp, Segorder where,
     if(n > bufsize)
       n = bufsize;
 
-    fprintf(outf, "S%c%02X%0*X", datarec, n + addr_width + 1, 2*addr_width, nextaddr);
+    hexo_putc(o, 'S');
+    hexo_putc(o, datarec);
+    hexo_byte(o, n + addr_width + 1);
+    hexo_num(o, nextaddr, 2*addr_width, 1);
     for(int i = 0; i < n; i++)
-      fprintf(outf, "%02X", buf[i]);
-    fprintf(outf, "%02X\n", cksum_srec(buf, n, nextaddr, addr_width));
+      hexo_byte(o, buf[i]);
+    hexo_byte(o, cksum_srec(buf, n, nextaddr, addr_width));
+    hexo_putc(o, '\n');
 
     buf += n;
     nextaddr += n;
@@ -713,21 +887,27 @@ static int b2srec(const AVRMEM *mem, const Segment *segp, Segorder where,
     if(cx->reccount >= 0 && cx->reccount <= 0xffffff) {
       int wd = cx->reccount <= 0xffff? 2: 3;
 
-      fprintf(outf, "S%c%02X%0*X%02X\n", '5' + (wd == 3), wd + 1, 2*wd,
-        cx->reccount, cksum_srec(NULL, 0, cx->reccount, wd));
+      hexo_putc(o, 'S');
+      hexo_putc(o, '5' + (wd == 3));
+      hexo_byte(o, wd + 1);
+      hexo_num(o, cx->reccount, 2*wd, 1);
+      hexo_byte(o, cksum_srec(NULL, 0, cx->reccount, wd));
+      hexo_putc(o, '\n');
     }
-    fprintf(outf, "S%c%02X%0*X", endrec, addr_width + 1, 2*addr_width, startaddr);
-    fprintf(outf, "%02X\n", cksum_srec(NULL, 0, startaddr, addr_width));
+    hexo_putc(o, 'S');
+    hexo_putc(o, endrec);
+    hexo_byte(o, addr_width + 1);
+    hexo_num(o, startaddr, 2*addr_width, 1);
+    hexo_byte(o, cksum_srec(NULL, 0, startaddr, addr_width));
+    hexo_putc(o, '\n');
   }
 
-  return hiaddr;
+  return o->err? -1: hiaddr;
 }
 
 static int srec_readrec(struct ihexsrec *srec, char *rec) {
-  int i, j;
-  char buf[8];
+  unsigned long long v;
   int offset, len, addr_width;
-  char *e;
   unsigned char cksum;
   int rc;
 
@@ -746,52 +926,35 @@ static int srec_readrec(struct ihexsrec *srec, char *rec) {
     addr_width = 4;             // S3 or S7-record
 
   // Reclen
-  if(offset + 2 > len)
+  if(offset + 2 > len || hexfield(rec + offset, 2, &v) < 0)
     return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  srec->reclen = strtoul(buf, &e, 16);
+  srec->reclen = v;
+  offset += 2;
   cksum += srec->reclen;
   srec->reclen -= (addr_width + 1);
-  if(e == buf || *e != 0)
-    return -1;
 
   // Load offset
-  if(offset + addr_width > len)
-    return -1;
-  for(i = 0; i < addr_width*2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  srec->loadofs = strtoull(buf, &e, 16);
-  if(e == buf || *e != 0)
+  if(offset + 2*addr_width > len || hexfield(rec + offset, 2*addr_width, &v) < 0)
     return -1;
+  srec->loadofs = v;
+  offset += 2*addr_width;
 
-  for(i = addr_width; i > 0; i--)
+  for(int i = addr_width; i > 0; i--)
     cksum += (srec->loadofs >> (i - 1)*8) & 0xff;
 
   // Data
-  for(j = 0; j < srec->reclen; j++) {
-    if(offset + 2 > len)
-      return -1;
-    for(i = 0; i < 2; i++)
-      buf[i] = rec[offset++];
-    buf[i] = 0;
-    srec->data[j] = strtoul(buf, &e, 16);
-    if(e == buf || *e != 0)
+  for(int j = 0; j < srec->reclen; j++) {
+    if(offset + 2 > len || hexfield(rec + offset, 2, &v) < 0)
       return -1;
+    srec->data[j] = v;
+    offset += 2;
     cksum += srec->data[j];
   }
 
   // Cksum
-  if(offset + 2 > len)
-    return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  srec->cksum = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
+  if(offset + 2 > len || hexfield(rec + offset, 2, &v) < 0)
     return -1;
+  srec->cksum = v;
 
   rc = 0xff - cksum;
   return rc;
@@ -801,7 +964,7 @@ static int srec_readrec(struct ihexsrec *srec, char *rec) {
 static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
   const AVRMEM *mem, const Segment *segp, unsigned int fileoffset) {
 
-  const char *errstr;
+  Linereader lr;
   unsigned int nextaddr, maxaddr;
   struct ihexsrec srec;
   int lineno, rc, hexdigs;
@@ -812,27 +975,22 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
   maxaddr = 0;
   reccount = 0;
   rewind(inf);
+  lr_open(&lr, inf);
 
   AVRMEM *any = fileio_any_memory("any");
 
-  for(char *buffer; (buffer = str_fgets(inf, &errstr)); mmt_free(buffer)) {
+  for(char *buffer; (buffer = lr_gets(&lr)); ) {
     lineno++;
-    int len = strlen(buffer);
-
-    if(len > 0 && buffer[len - 1] == '\n')
-      buffer[--len] = 0;
-    if(len == 0 || buffer[0] != 'S')
+    if(buffer[0] != 'S')
       continue;
     rc = srec_readrec(&srec, buffer);
     if(rc < 0) {
       pmsg_error("invalid record at line %d of %s\n", lineno, infile);
-      mmt_free(buffer);
       goto error;
     }
     if(rc != srec.cksum) {
       pmsg_error("checksum mismatch at line %d of %s\n", lineno, infile);
       imsg_error("checksum=0x%02x, computed checksum=0x%02x\n", srec.cksum, rc);
-      mmt_free(buffer);
       goto error;
     }
 
@@ -858,14 +1016,12 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
 
     case '4':                  // S4: symbol record (LSI extension)
       pmsg_error("not supported record at line %d of %s\n", lineno, infile);
-      mmt_free(buffer);
       goto error;
 
     case '5':                  // S5: count of S1, S2 and S3 records previously tx'd
       if(srec.loadofs != reccount) {
         pmsg_error("count of transmitted data records mismatch at line %d of %s\n", lineno, infile);
         imsg_error("transmitted data records= %d, expected value= %d\n", reccount, srec.loadofs);
-        mmt_free(buffer);
         goto error;
       }
       break;
@@ -873,13 +1029,11 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
     case '7':                  // S7: end record for 32 bit addresses
     case '8':                  // S8: end record for 24 bit addresses
     case '9':                  // S9: end record for 16 bit addresses
-      mmt_free(buffer);
       goto done;
 
     default:
       pmsg_error("do not know how to deal with rectype S%d at line %d of %s\n",
         srec.rectyp, lineno, infile);
-      mmt_free(buffer);
       goto error;
     }
 
@@ -892,7 +1046,6 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
           pmsg_error("address 0x%0*x below memory offset 0x%x at line %d of %s\n",
             hexdigs, nextaddr, fileoffset, lineno, infile);
           imsg_error("use -F to skip this check\n");
-          mmt_free(buffer);
           goto error;
         }
         pmsg_warning("address 0x%0*x below memory offset 0x%x at line %d of %s: ",
@@ -912,7 +1065,6 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
           pmsg_error("Motorola S-Record [0x%06x, 0x%06x] out of range [0, 0x%06x]\n",
             nextaddr, nextaddr + srec.reclen - 1, anysize - 1);
           imsg_error("at line %d of %s; use -F to skip this check\n", lineno, infile);
-          mmt_free(buffer);
           goto error;
         }
         pmsg_warning("Motorola S-Record [0x%06x, 0x%06x] out of range [0, 0x%06x]: ",
@@ -933,7 +1085,6 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
           pmsg_error("signature of %s incompatible with file's (%s);\n", p->desc,
             str_ccmcunames_signature(any->buf + nextaddr, PM_ALL));
           imsg_error("use -F to override this check\n");
-          mmt_free(buffer);
           goto error;
         }
 
@@ -943,13 +1094,14 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
     }
   }
 
-  if(errstr) {
-    pmsg_error("read error in Motorola S-Record file %s: %s\n", infile, errstr);
+  if(lr.err) {
+    pmsg_error("read error in Motorola S-Record file %s: %s\n", infile, lr.err);
     goto error;
   }
 
   pmsg_warning("no end of file record found for Motorola S-Records file %s\n", infile);
 done:
+  lr_close(&lr);
   rc = any2mem(p, mem, segp, any, maxaddr);
   avr_free_mem(any);
   if(!rc)
@@ -957,6 +1109,7 @@ done:
   return rc;
 
 error:
+  lr_close(&lr);
   avr_free_mem(any);
   return -1;
 }
@@ -1313,14 +1466,14 @@ static int fileio_imm(struct fioparms *fio, const char *fname, FILE *f_unused,
   return n;
 }
 
-static int fileio_ihex(struct fioparms *fio, const char *filename, FILE *f,
+static int fileio_ihex(struct fioparms *fio, const char *filename, FILE *f, Hexout *o,
   const AVRPART *p, const AVRMEM *mem, const Segment *segp, FILEFMT ffmt, Segorder where) {
 
   int rc;
 
   switch(fio->op) {
   case FIO_WRITE:
-    rc = b2ihex(p, mem, segp, where, 32, fio->fileoffset, filename, f, ffmt);
+    rc = b2ihex(p, mem, segp, where, 32, fio->fileoffset, filename, o, ffmt);
     break;
 
   case FIO_READ:
@@ -1335,14 +1488,14 @@ static int fileio_ihex(struct fioparms *fio, const char *filename, FILE *f,
   return rc < 0? -1: rc;
 }
 
-static int fileio_srec(struct fioparms *fio, const char *filename, FILE *f,
+static int fileio_srec(struct fioparms *fio, const char *filename, FILE *f, Hexout *o,
   const AVRPART *p, const AVRMEM *mem, const Segment *segp, Segorder where) {
 
   int rc;
 
   switch(fio->op) {
   case FIO_WRITE:
-    rc = b2srec(mem, segp, where, 32, fio->fileoffset, filename, f);
+    rc = b2srec(mem, segp, where, 32, fio->fileoffset, filename, o);
     break;
 
   case FIO_READ:
@@ -1691,6 +1844,167 @@ int segment_normalise(const AVRMEM *mem, Segment *segp) {
   return 0;
 }
 
+/*
+ * Decoded input files are kept in memory so that several -U operations or
+ * terminal commands reading the same file, eg, write then verify, only
+ * parse it once. An entry is keyed by file identity, modification time and
+ * size as well as everything else that influences decoding: the format, the
+ * part, the memory and the segments. Writing to a file drops its entries.
+ */
+
+#define FIO_NCACHE 8            // Number of decoded files kept
+#define FIO_CACHE_MAXMEM (1<<22)        // Don't keep images of larger memories
+#define FIO_CACHE_BLOCK 4096    // Unit of memory images that is kept or dropped
+
+// Nanoseconds of the modification time where struct stat has them
+#if defined(__APPLE__)
+#define fio_mtime_ns(sb) ((long) (sb).st_mtimespec.tv_nsec)
+#elif defined(WIN32)
+#define fio_mtime_ns(sb) 0L
+#else
+#define fio_mtime_ns(sb) ((long) (sb).st_mtim.tv_nsec)
+#endif
+
+typedef struct fio_cached {
+  char *fname;                  // File name as given
+  dev_t dev;
+  ino_t ino;
+  time_t mtime;
+  long mtime_ns;
+  off_t size;
+  FILEFMT format;
+  int ovsigck, fileoffset;
+  const char *pdesc, *mdesc;    // Part and memory
+  int msize, n;
+  Segment *segs;
+  unsigned char *buf, *tags;    // Decoded memory image, only blocks with allocated bytes are kept
+  int rc;                       // Return value of the decoding before trimming
+} Fio_cached;
+
+static void fio_cache_drop(Fio_cached *c) {
+  mmt_free(c->fname);
+  mmt_free(c->segs);
+  mmt_free(c->buf);
+  mmt_free(c->tags);
+  memset(c, 0, sizeof *c);
+}
+
+// Free all decoded images
+void fileio_cache_free(void) {
+  if(cx->fio_cache) {
+    for(int i = 0; i < FIO_NCACHE; i++)
+      fio_cache_drop(cx->fio_cache + i);
+    mmt_free(cx->fio_cache);
+    cx->fio_cache = NULL;
+  }
+}
+
+// Forget all decoded images of file fname, eg, because it is about to be overwritten
+static void fio_cache_forget(const char *fname) {
+  struct stat sb;
+  int known = stat(fname, &sb) == 0;
+
+  if(cx->fio_cache)
+    for(int i = 0; i < FIO_NCACHE; i++) {
+      Fio_cached *c = cx->fio_cache + i;
+
+      if(c->fname && (str_eq(c->fname, fname) || (known && c->dev == sb.st_dev && c->ino == sb.st_ino)))
+        fio_cache_drop(c);
+    }
+}
+
+// Set key of c for reading fname; return -1 if the file should not be cached
+static int fio_cache_key(Fio_cached *c, const char *fname, FILEFMT format, const struct fioparms *fio,
+  const AVRPART *p, const AVRMEM *mem, int n, const Segment *seglist) {
+
+  struct stat sb;
+
+  if(mem->size > FIO_CACHE_MAXMEM || stat(fname, &sb) < 0 || !S_ISREG(sb.st_mode))
+    return -1;
+
+  memset(c, 0, sizeof *c);
+  c->fname = (char *) fname;
+  c->dev = sb.st_dev;
+  c->ino = sb.st_ino;
+  c->mtime = sb.st_mtime;
+  c->mtime_ns = fio_mtime_ns(sb);
+  c->size = sb.st_size;
+  c->format = format;
+  c->ovsigck = ovsigck;
+  c->fileoffset = fio->fileoffset;
+  c->pdesc = p->desc;
+  c->mdesc = mem->desc;
+  c->msize = mem->size;
+  c->n = n;
+  c->segs = (Segment *) seglist;
+
+  return 0;
+}
+
+static int fio_cache_match(const Fio_cached *c, const Fio_cached *key) {
+  return c->fname && str_eq(c->fname, key->fname) && c->dev == key->dev && c->ino == key->ino &&
+    c->mtime == key->mtime && c->mtime_ns == key->mtime_ns && c->size == key->size && c->format == key->format &&
+    c->ovsigck == key->ovsigck && c->fileoffset == key->fileoffset &&
+    str_eq(c->pdesc, key->pdesc) && str_eq(c->mdesc, key->mdesc) && c->msize == key->msize &&
+    c->n == key->n && memcmp(c->segs, key->segs, key->n*sizeof *key->segs) == 0;
+}
+
+// Copy a previously decoded image of the file into mem; return decoding rc or -1 if not cached
+static int fio_cache_get(const Fio_cached *key, const AVRMEM *mem) {
+  if(cx->fio_cache)
+    for(int i = 0; i < FIO_NCACHE; i++) {
+      Fio_cached *c = cx->fio_cache + i;
+
+      if(fio_cache_match(c, key)) {
+        for(int k = 0; k < key->n; k++) {
+          int addr = key->segs[k].addr, end = addr + key->segs[k].len;
+
+          for(int a = addr, b; a < end; a = b) {
+            b = (a/FIO_CACHE_BLOCK + 1)*FIO_CACHE_BLOCK;
+            if(b > end)
+              b = end;
+            if(is_memset(c->tags + a - a%FIO_CACHE_BLOCK, 0, FIO_CACHE_BLOCK))
+              memset(mem->buf + a, 0xff, b - a);        // Block was not kept: no file data
+            else
+              memcpy(mem->buf + a, c->buf + a, b - a);
+          }
+          memcpy(mem->tags + addr, c->tags + addr, end - addr);
+        }
+        pmsg_debug("reusing decoded %s for %s %s\n", key->fname, key->pdesc, key->mdesc);
+        return c->rc;
+      }
+    }
+
+  return -1;
+}
+
+// Remember the decoded image in mem under key
+static void fio_cache_put(const Fio_cached *key, const AVRMEM *mem, int rc) {
+  if(!cx->fio_cache)
+    cx->fio_cache = mmt_malloc(FIO_NCACHE*sizeof *cx->fio_cache);
+
+  Fio_cached *c = cx->fio_cache + cx->fio_ncache++%FIO_NCACHE;
+
+  fio_cache_drop(c);
+  *c = *key;
+  c->fname = mmt_strdup(key->fname);
+  c->segs = mmt_malloc(key->n*sizeof *c->segs);
+  memcpy(c->segs, key->segs, key->n*sizeof *c->segs);
+  // Only copy blocks with file data; the rest of the fresh allocations stay out of RSS
+  int nblocks = (mem->size + FIO_CACHE_BLOCK - 1)/FIO_CACHE_BLOCK;
+
+  c->buf = mmt_malloc(nblocks*FIO_CACHE_BLOCK);
+  c->tags = mmt_malloc(nblocks*FIO_CACHE_BLOCK);
+  for(int a = 0, len; a < mem->size; a += len) {
+    len = mem->size - a < FIO_CACHE_BLOCK? mem->size - a: FIO_CACHE_BLOCK;
+    if(!is_memset(mem->tags + a, 0, len)) {
+      memcpy(c->buf + a, mem->buf + a, len);
+      memcpy(c->tags + a, mem->tags + a, len);
+    }
+  }
+  c->rc = rc;
+}
+
 static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT format,
   const AVRPART *p, const AVRMEM *mem, int n, Segment *seglist) {
 
@@ -1750,6 +2064,19 @@ static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT fo
   }
 #endif
 
+  Fio_cached key;
+  int cacheable = 0;
+
+  if(format != FMT_IMM && !using_stdio) {
+    if(fio.op == FIO_WRITE)
+      fio_cache_forget(fname);
+    else if(fio_cache_key(&key, fname, format, &fio, p, mem, n, seglist) == 0) {
+      cacheable = 1;
+      if((rc = fio_cache_get(&key, mem)) >= 0)
+        goto trim;
+    }
+  }
+
   if(format != FMT_IMM) {
     if(!using_stdio) {
       f = fopen(fname, fio.mode);
@@ -1760,6 +2087,11 @@ static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT fo
     }
   }
 
+  Hexout ho = { 0 };
+
+  if(fio.op == FIO_WRITE && (format == FMT_IHEX || format == FMT_IHXC || format == FMT_SREC))
+    hexo_open(&ho, f);          // One output buffer for all segments of the file
+
   rc = 0;
   for(int i = 0; i < n; i++) {
     int addr = seglist[i].addr, len = seglist[i].len;
@@ -1769,7 +2101,7 @@ static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT fo
 
     if(fio.op == FIO_READ)      // Fill unspecified memory in segment
       memset(mem->buf + addr, 0xff, len);
-    memset(mem->tags + addr, 0, len);
+    memset_sparse(mem->tags + addr, 0, len);    // Keep fresh, unused tags out of RSS
 
     Segorder where = i == 0? FIRST_SEG: 0;
 
@@ -1781,11 +2113,11 @@ static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT fo
     switch(format) {
     case FMT_IHEX:
     case FMT_IHXC:
-      thisrc = fileio_ihex(&fio, fname, f, p, mem, seglist + i, format, where);
+      thisrc = fileio_ihex(&fio, fname, f, &ho, p, mem, seglist + i, format, where);
       break;
 
     case FMT_SREC:
-      thisrc = fileio_srec(&fio, fname, f, p, mem, seglist + i, where);
+      thisrc = fileio_srec(&fio, fname, f, &ho, p, mem, seglist + i, where);
       break;
 
     case FMT_RBIN:
@@ -1818,12 +2150,27 @@ static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT fo
       pmsg_error("invalid %s file format: %d\n", fio.iodesc, format);
       return -1;
     }
-    if(thisrc < 0)
-      return thisrc;
+    if(thisrc < 0) {
+      rc = thisrc;
+      break;
+    }
     if(thisrc > rc)
       rc = thisrc;
   }
 
+  if(ho.buf && hexo_close(&ho) < 0)
+    rc = -1;
+  if(format != FMT_IMM && !using_stdio && fclose(f) == EOF && fio.op == FIO_WRITE && rc >= 0) {
+    pmsg_ext_error("unable to write %s file %s: %s\n", fio.iodesc, fname, strerror(errno));
+    rc = -1;
+  }
+  if(rc < 0)
+    return rc;
+
+  if(cacheable && rc >= 0)       // Failed decodings are not remembered
+    fio_cache_put(&key, mem, rc);
+
+trim:
   // On reading flash other than for verify set the size to location of highest non-0xff byte
   if(rc > 0 && oprwv == FIO_READ) {
     int hiaddr = avr_mem_hiaddr(mem);   // @@@ Should check segments only, not all file
@@ -1832,10 +2179,6 @@ static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT fo
       rc = hiaddr;
   }
 
-  if(format != FMT_IMM && !using_stdio) {
-    fclose(f);
-  }
-
   return rc;
 }
 
@@ -131,6 +131,8 @@ struct pdata {
   int (*set_sck)(const PROGRAMMER *, unsigned char *);
 
   unsigned char signature_cache[2];     // Used in jtag3_read_byte()
+
+  int edbg_packets;             // Number of CMSIS-DAP packets the EDBG firmware can buffer
 };
 
 #define my (*(struct pdata *) (pgm->cookie))
@@ -149,8 +151,6 @@ struct pdata {
 static int jtag3_open(PROGRAMMER *pgm, const char *port);
 static int jtag3_edbg_prepare(const PROGRAMMER *pgm);
 static int jtag3_edbg_signoff(const PROGRAMMER *pgm);
-static int jtag3_edbg_send(const PROGRAMMER *pgm, unsigned char *data, size_t len);
-static int jtag3_edbg_recv_frame(const PROGRAMMER *pgm, unsigned char **msg);
 
 static int jtag3_initialize(const PROGRAMMER *pgm, const AVRPART *p);
 static int jtag3_chip_erase(const PROGRAMMER *pgm, const AVRPART *p);
@@ -477,7 +477,23 @@ int jtag3_send(const PROGRAMMER *pgm, unsigned char *data, size_t len) {
   return 0;
 }
 
-static int jtag3_edbg_send(const PROGRAMMER *pgm, unsigned char *data, size_t len) {
+// Set the number of packets the EDBG firmware buffers if n > 0; return that number
+int jtag3_edbg_packets(const PROGRAMMER *pgm, int n) {
+  if(n > 0)
+    my.edbg_packets = n;
+  return my.edbg_packets;
+}
+
+// Discard n replies still outstanding after an error and stop pipelining for the session
+static void jtag3_edbg_drain(const PROGRAMMER *pgm, int n) {
+  unsigned char buf[USBDEV_MAX_XFER_3];
+
+  while(n-- > 0 && serial_recv(&pgm->fd, buf, pgm->fd.usb.max_xfer) >= 0)
+    continue;
+  my.edbg_packets = 1;
+}
+
+int jtag3_edbg_send(const PROGRAMMER *pgm, unsigned char *data, size_t len) {
   unsigned char buf[USBDEV_MAX_XFER_3];
   unsigned char status[USBDEV_MAX_XFER_3];
   int rv;
@@ -493,12 +509,13 @@ static int jtag3_edbg_send(const PROGRAMMER *pgm, unsigned char *data, size_t le
   // 4 bytes overhead for CMD, fragment #, and length info
   int max_xfer = pgm->fd.usb.max_xfer;
 
-  int nfragments = (len + max_xfer - 1)/max_xfer;
+  // First fragment carries max_xfer - 8 data bytes (token and seq#), the others max_xfer - 4
+  int nfragments = (int) len <= max_xfer - 8? 1: 1 + ((int) len - (max_xfer - 8) + max_xfer - 5)/(max_xfer - 4);
 
   if(nfragments > 1) {
     pmsg_debug("%s(): fragmenting into %d packets\n", __func__, nfragments);
   }
-  int frag;
+  int frag, nsent = 0, nacked = 0, window = my.edbg_packets > 1? my.edbg_packets: 1;
 
   for(frag = 0; frag < nfragments; frag++) {
     int this_len;
@@ -517,7 +534,7 @@ static int jtag3_edbg_send(const PROGRAMMER *pgm, unsigned char *data, size_t le
       u16_to_b2(buf + 6, my.command_sequence);
       if(this_len < 0) {
         pmsg_error("unexpected this_len = %d\n", this_len);
-        return -1;
+        goto error;
       }
       memcpy(buf + 8, data, this_len);
     } else {
@@ -526,31 +543,68 @@ static int jtag3_edbg_send(const PROGRAMMER *pgm, unsigned char *data, size_t le
       buf[3] = (this_len) & 0xff;
       if(this_len < 0) {
         pmsg_error("unexpected this_len = %d\n", this_len);
-        return -1;
+        goto error;
       }
       memcpy(buf + 4, data, this_len);
     }
 
     if(serial_send(&pgm->fd, buf, max_xfer) != 0) {
       pmsg_notice("%s(): unable to send command to serial port\n", __func__);
-      return -1;
-    }
-    rv = serial_recv(&pgm->fd, status, max_xfer);
-
-    if(rv < 0) {
-      // Timeout in receive
-      pmsg_notice2("%s(): timeout receiving packet\n", __func__);
-      return -1;
-    }
-    if(status[0] != EDBG_VENDOR_AVR_CMD || (frag == nfragments - 1 && status[1] != 0x01)) {
-      // What to do in this case?
-      pmsg_notice("%s(): unexpected response 0x%02x, 0x%02x\n", __func__, status[0], status[1]);
+      goto error;
     }
+    nsent++;
     data += this_len;
     len -= this_len;
+
+    // Collect the acknowledgements once the firmware's buffers are full or all fragments are out
+    if(frag + 1 - nacked < window && frag < nfragments - 1)
+      continue;
+    for(; nacked <= frag; nacked++) {
+      rv = serial_recv(&pgm->fd, status, max_xfer);
+
+      if(rv < 0) {
+        // Timeout in receive
+        pmsg_notice2("%s(): timeout receiving packet\n", __func__);
+        goto error;
+      }
+      if(status[0] != EDBG_VENDOR_AVR_CMD || (nacked == nfragments - 1 && status[1] != 0x01)) {
+        // What to do in this case?
+        pmsg_notice("%s(): unexpected response 0x%02x, 0x%02x\n", __func__, status[0], status[1]);
+      }
+    }
   }
 
   return 0;
+
+error:
+  jtag3_edbg_drain(pgm, nsent - nacked);     // Acknowledgements still outstanding
+  return -1;
+}
+
+/*
+ * Ask the CMSIS-DAP firmware how many packets it can buffer. The packet size
+ * is deliberately not taken from DAP_Info: the USB transport has already set
+ * max_xfer on opening the device (usbhid_open() by probing with full-sized
+ * packets, usbdev_open() from the endpoint size) and clamped it to
+ * USBDEV_MAX_XFER_3, the size of the buffers here. The Atmel firmware only
+ * answers packets of exactly the transport size, and a larger DAP_Info value
+ * would overrun these buffers.
+ */
+void jtag3_edbg_info(const PROGRAMMER *pgm) {
+  unsigned char buf[USBDEV_MAX_XFER_3];
+  unsigned char status[USBDEV_MAX_XFER_3];
+
+  memset(buf, 0, USBDEV_MAX_XFER_3);
+  buf[0] = CMSISDAP_CMD_INFO;
+  my.edbg_packets = 1;
+  buf[1] = CMSISDAP_INFO_PACKET_COUNT;
+  if(serial_send(&pgm->fd, buf, pgm->fd.usb.max_xfer) == 0 &&
+    serial_recv(&pgm->fd, status, pgm->fd.usb.max_xfer) == pgm->fd.usb.max_xfer &&
+    status[0] == CMSISDAP_CMD_INFO && status[1] == 1 && status[2] > 1)
+    my.edbg_packets = status[2] > 15? 15: status[2];  // Max 15 fragments per message anyway
+
+  pmsg_notice2("EDBG packet size %d, %d packet%s buffered\n", pgm->fd.usb.max_xfer,
+    my.edbg_packets, str_plural(my.edbg_packets));
 }
 
 // Send out all the CMSIS-DAP stuff needed to prepare the ICE
@@ -676,7 +730,7 @@ static int jtag3_recv_frame(const PROGRAMMER *pgm, unsigned char **msg) {
   return rv;
 }
 
-static int jtag3_edbg_recv_frame(const PROGRAMMER *pgm, unsigned char **msg) {
+int jtag3_edbg_recv_frame(const PROGRAMMER *pgm, unsigned char **msg) {
   int rv, len = 0;
   unsigned char *buf;
   unsigned char *request;
@@ -690,15 +744,17 @@ static int jtag3_edbg_recv_frame(const PROGRAMMER *pgm, unsigned char **msg) {
 
   int nfrags = 0;
   int thisfrag = 0;
+  int nreq = 0, nrecv = 0, window = my.edbg_packets > 1? my.edbg_packets: 1;
 
+  request[0] = EDBG_VENDOR_AVR_RSP;
   do {
-    request[0] = EDBG_VENDOR_AVR_RSP;
-
-    if(serial_send(&pgm->fd, request, pgm->fd.usb.max_xfer) != 0) {
-      pmsg_notice("%s(): unable to send CMSIS-DAP vendor command\n", __func__);
-      mmt_free(request);
-      mmt_free(*msg);
-      return -1;
+    // Keep up to window fragment requests outstanding; only one until nfrags is known
+    while(nreq < (thisfrag? nfrags: 1) && nreq - (thisfrag? thisfrag - 1: 0) < window) {
+      if(serial_send(&pgm->fd, request, pgm->fd.usb.max_xfer) != 0) {
+        pmsg_notice("%s(): unable to send CMSIS-DAP vendor command\n", __func__);
+        goto error;
+      }
+      nreq++;
     }
 
     rv = serial_recv(&pgm->fd, buf, pgm->fd.usb.max_xfer);
@@ -706,16 +762,13 @@ static int jtag3_edbg_recv_frame(const PROGRAMMER *pgm, unsigned char **msg) {
     if(rv < 0) {
       // Timeout in receive
       pmsg_notice2("%s(): timeout receiving packet\n", __func__);
-      mmt_free(*msg);
-      mmt_free(request);
-      return -1;
+      goto error;
     }
+    nrecv++;
 
     if(buf[0] != EDBG_VENDOR_AVR_RSP) {
       pmsg_notice("%s(): unexpected response 0x%02x\n", __func__, buf[0]);
-      mmt_free(*msg);
-      mmt_free(request);
-      return -1;
+      goto error;
     }
 
     if(buf[1] == 0) {
@@ -725,9 +778,7 @@ static int jtag3_edbg_recv_frame(const PROGRAMMER *pgm, unsigned char **msg) {
        */
       cx->usb_access_error = 1; // Also end up here on wrong USB permissions
       pmsg_notice("%s(): no response available\n", __func__);
-      mmt_free(*msg);
-      mmt_free(request);
-      return -1;
+      goto error;
     }
 
     // Calculate fragment information
@@ -738,17 +789,13 @@ static int jtag3_edbg_recv_frame(const PROGRAMMER *pgm, unsigned char **msg) {
     } else {
       if(nfrags != (buf[1] & 0x0F)) {
         pmsg_notice("%s(): inconsistent # of fragments; had %d, now %d\n", __func__, nfrags, (buf[1] & 0x0F));
-        mmt_free(*msg);
-        mmt_free(request);
-        return -1;
+        goto error;
       }
     }
     if(thisfrag != ((buf[1] >> 4) & 0x0F)) {
       pmsg_notice("%s(): inconsistent fragment number; expect %d, got %d\n",
         __func__, thisfrag, ((buf[1] >> 4) & 0x0F));
-      mmt_free(*msg);
-      mmt_free(request);
-      return -1;
+      goto error;
     }
 
     int thislen = (buf[2] << 8) | buf[3];
@@ -769,6 +816,12 @@ static int jtag3_edbg_recv_frame(const PROGRAMMER *pgm, unsigned char **msg) {
 
   mmt_free(request);
   return len;
+
+error:
+  jtag3_edbg_drain(pgm, nreq - nrecv);  // Replies to fragment requests still outstanding
+  mmt_free(request);
+  mmt_free(*msg);
+  return -1;
 }
 
 int jtag3_recv(const PROGRAMMER *pgm, unsigned char **msg) {
@@ -1758,6 +1811,8 @@ int jtag3_open_common(PROGRAMMER *pgm, const char *port, int mode_switch) {
   if(pgm->fd.usb.eep == 0) {
     pgm->flag |= PGM_FL_IS_EDBG;
     pmsg_notice2("found CMSIS-DAP compliant device, using EDBG protocol\n");
+    if(!str_starts(pgmid, "xplainedmini"))
+      jtag3_edbg_info(pgm);
   }
 
   // Make USB serial number available to programmer
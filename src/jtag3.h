@@ -54,6 +54,12 @@ extern "C" {
   void jtag3_setup(PROGRAMMER *pgm);
   void jtag3_teardown(PROGRAMMER *pgm);
 
+  // EDBG transport, also exercised by tools/test-edbg.c against a stand-in for the device
+  int jtag3_edbg_send(const PROGRAMMER *pgm, unsigned char *data, size_t len);
+  int jtag3_edbg_recv_frame(const PROGRAMMER *pgm, unsigned char **msg);
+  void jtag3_edbg_info(const PROGRAMMER *pgm);
+  int jtag3_edbg_packets(const PROGRAMMER *pgm, int n);
+
 #ifdef __cplusplus
 }
 #endif
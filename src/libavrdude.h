@@ -142,6 +142,7 @@ extern "C" {
   LNODEID lprev(LNODEID);       // Previous item in the list
   void *ldata(LNODEID);         // Data at the current position
   int lsize(LISTID);            // Number of elements in the list
+  unsigned int lstamp(LISTID);  // Changes whenever the list is modified
 
   int ladd(LISTID lid, void *p);
   int laddo(LISTID lid, void *p, int (*compare)(const void *p1, const void *p2), LNODEID *firstdup);
@@ -307,6 +308,8 @@ typedef struct opcode {
  *  - dev_part_strct() in developer_opts.c
  *  - avr_new_part() and/or avr_new_mem() in avrpart.c for
  *    initialisation; note that all const char * must be initialised with ""
+ *  - CC_PART_FIELDS or CC_MEM_FIELDS in confcache.c, or cc_wpart() and
+ *    cc_rpart() there for pointers, so config snapshots restore the field
  */
 typedef struct avrpart {
   const char *desc;             // Long part name
@@ -608,6 +611,7 @@ extern "C" {
   AVRMEM *avr_dup_mem(const AVRMEM *m);
   void avr_free_mem(AVRMEM *m);
   void avr_free_memalias(AVRMEM_ALIAS *m);
+  void avr_index_invalidate(void);
   AVRMEM *avr_locate_mem(const AVRPART *p, const char *desc);
   AVRMEM *avr_locate_mem_noalias(const AVRPART *p, const char *desc);
   AVRMEM *avr_locate_fuse_by_offset(const AVRPART *p, unsigned int off);
@@ -900,8 +904,8 @@ extern struct serial_device usbhid_serdev;
 #define serial_setparams (serdev->setparams)
 #define serial_close (serdev->close)
 #define serial_rawclose (serdev->rawclose)
-#define serial_send (serdev->send)
-#define serial_recv (serdev->recv)
+#define serial_send stats_serial_send       // Counts bytes and round trips, see stats.c
+#define serial_recv stats_serial_recv
 #define serial_drain (serdev->drain)
 #define serial_set_dtr_rts (serdev->set_dtr_rts)
 
@@ -1029,6 +1033,16 @@ typedef struct programmer {
     unsigned int pg_size, unsigned int addr, unsigned int n);
   int (*paged_load)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
     unsigned int pg_size, unsigned int addr, unsigned int n);
+  // Pipelined paged load: queue a request (LIBAVRDUDE_SOFTFAIL if window full), collect oldest
+  int (*paged_load_async)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+    unsigned int pg_size, unsigned int addr, unsigned int n);
+  int (*paged_load_collect)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+    unsigned int pg_size, unsigned int addr, unsigned int n);
+  // Pipelined paged write: queue a page (LIBAVRDUDE_SOFTFAIL if window full), await oldest
+  int (*paged_write_async)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+    unsigned int pg_size, unsigned int addr, unsigned int n);
+  int (*paged_write_collect)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+    unsigned int pg_size, unsigned int addr, unsigned int n);
   int (*page_erase)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, unsigned int addr);
   void (*write_setup)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m);
   int (*write_byte)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
@@ -1179,6 +1193,7 @@ extern "C" {
   int avr_mem_is_known(const char *str);
   int avr_mem_might_be_known(const char *str);
   int avr_mem_hiaddr(const AVRMEM *mem);
+  int avr_mem_next_allocated(const AVRMEM *mem, int from, int to);
 
   int avr_chip_erase(const PROGRAMMER *pgm, const AVRPART *p);
   int avr_unlock(const PROGRAMMER *pgm, const AVRPART *p);
@@ -1201,6 +1216,26 @@ extern "C" {
     unsigned int addr);
   int avr_flush_cache(const PROGRAMMER *pgm, const AVRPART *p);
   int avr_reset_cache(const PROGRAMMER *pgm, const AVRPART *p);
+  int avr_write_mem_delta(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
+    int size, int *npagesp);
+
+#ifdef __cplusplus
+}
+#endif
+
+// See stats.c
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  void stats_enable(void);
+  void stats_begin(const char *name, const char *memory);
+  void stats_end(void);
+  void stats_memory(const char *memory, int write, int pages, int bytes);
+  int stats_serial_send(const union filedescriptor *fd, const unsigned char *buf, size_t len);
+  int stats_serial_recv(const union filedescriptor *fd, unsigned char *buf, size_t len);
+  int stats_json(const char *fname, const char *programmer, const char *part);
 
 #ifdef __cplusplus
 }
@@ -1261,6 +1296,7 @@ extern "C" {
   int segment_normalise(const AVRMEM *mem, Segment *segp);
   int fileio_segments(int oprwv, const char *filename, FILEFMT format,
     const AVRPART *p, const AVRMEM *mem, int n, const Segment *seglist);
+  void fileio_cache_free(void);
 
 #ifdef __cplusplus
 }
@@ -1271,7 +1307,8 @@ extern "C" {
 enum {
   DEVICE_READ,
   DEVICE_WRITE,
-  DEVICE_VERIFY
+  DEVICE_VERIFY,
+  DEVICE_DELTA                  // Write only pages that differ from the device
 };
 
 enum updateflags {
@@ -1321,6 +1358,7 @@ extern "C" {
   int update_is_readable(const char *fn);
 
   int update_dryrun(const AVRPART *p, UPDATE *upd);
+  int update_decode_input(const AVRPART *p, const UPDATE *upd);
 
   AVRMEM **memory_list(const char *mstr, const PROGRAMMER *pgm, const AVRPART *p,
     int *np, int *rwvsoftp, int *dry);
@@ -1379,7 +1417,7 @@ extern "C" {
   int init_config(void);
   void cleanup_config(void);
   int read_config(const char *file);
-  const char *cache_string(const char *file);
+  const char *cache_string(const char *file);  // Result valid until cleanup_config()
   unsigned char *cfg_unescapeu(unsigned char *d, const unsigned char *s);
   char *cfg_unescape(char *d, const char *s);
   char *cfg_escape(const char *s);
@@ -1454,6 +1492,7 @@ typedef struct {
 
 typedef struct {
   int from, to, mnemo, labelno, is_func;
+  int next;                     // 1 + index of previous jumpcall to same destination, 0 if none
 } Dis_jumpcall;
 
 typedef struct {
@@ -1625,6 +1664,7 @@ extern "C" {
 
   int setport_from_serialadapter(char **portp, const SERIALADAPTER *ser, const char *sernum);
   int setport_from_vid_pid(char **portp, int vid, int pid, const char *sernum);
+  int serialport_vid_pid(const char *port, int *vidp, int *pidp);
   int list_available_serialports(LISTID programmers);
   int touch_serialport(char **portp, int baudrate, int nwaits);
 
@@ -1675,6 +1715,7 @@ extern "C" {
   bool is_bigendian(void);
   void change_endian(void *p, int size);
   int is_memset(const void *p, char c, size_t n);
+  void *memset_sparse(void *p, int c, size_t n);
   unsigned long long int str_ull(const char *str, char **endptr, int base);
   int looks_like_number(const char *str);
   Str2data *str_todata(const char *str, int type, const AVRPART *part, const char *memstr);
@@ -1738,6 +1779,16 @@ extern "C" {
 }
 #endif
 
+#if !defined(WIN32)
+#define SER_RXBUFS 4            // Ports that can hold read-ahead data at the same time
+
+typedef struct {
+  int used, fd;                 // Buffer is in use for port fd
+  size_t head, len;             // Start and number of buffered bytes not yet consumed
+  unsigned char buf[4096];      // Bytes read from the port ahead of ser_recv() requests
+} Ser_rxbuf;
+#endif
+
 /*
  * Context structure
  *
@@ -1760,6 +1811,13 @@ typedef struct {
   int avr_last_percent;         // Last valid percentage for report_progress()
   double avr_start_time;        // Start time in s of report_progress() activity
 
+  // Static variables from avrpart.c
+  int avr_idx_off;              // Do not use lookup indices (set while parsing config files)
+  int avr_idx_gen;              // Generation of lookup indices, see avr_index_invalidate()
+  struct avr_part_index *avr_pidx;      // Per-list indices for locate_part() etc, most recent first
+  struct avr_mem_index **avr_midx;      // Open-addressing table of per-part memory indices
+  int avr_nmidx, avr_nmidx_used;        // Size of that table and number of entries in use
+
   // Static variables from bitbang.c
   int bb_delay_decrement;
 
@@ -1772,7 +1830,10 @@ typedef struct {
 #endif
 
   // Static variables from config.c
-  char **cfg_hstrings[1 << 12]; // Hash lists for cache_string()
+  struct cfg_hstring *cfg_hstrings;     // Open-addressing table of strings for cache_string()
+  size_t cfg_nhstrings, cfg_nhused;     // Table size (power of 2) and number of strings in it
+  struct cfg_arena *cfg_arena;  // Chain of memory blocks holding the hashed strings
+  size_t cfg_hlookups, cfg_hprobes, cfg_hmaxprobes;     // Statistics of cache_string() lookups
   LISTID cfg_comms;             // A chain of comment lines
   LISTID cfg_prologue;          // Comment lines at start of avrdude.conf
   char *cfg_lkw;                // Last seen keyword
@@ -1803,6 +1864,7 @@ typedef struct {
 #else
   struct termios ser_original_termios;
   int ser_saved_original_termios;
+  Ser_rxbuf ser_rx[SER_RXBUFS];        // Per-port receive buffers
 #endif
 
   // Static variables from term.c
@@ -1823,8 +1885,10 @@ typedef struct {
   const char **upd_wrote, **upd_termcmds;
   int upd_nfwritten, upd_nterms;
 
-  // Static variable from fileio.c
+  // Static variables from fileio.c
   int reccount;
+  struct fio_cached *fio_cache; // Decoded input files, see fileio_segments_normalise()
+  int fio_ncache;               // Number of images put into the cache so far
 
   // Static variables from disasm.c
   int dis_initopts, dis_flashsz, dis_flashsz2, dis_addrwidth, dis_sramwidth;
@@ -1832,8 +1896,12 @@ typedef struct {
   Dis_options dis_opts;
   int dis_jumpcallN, dis_symbolN, *dis_jumpable, dis_start, dis_end;
   Dis_jumpcall *dis_jumpcalls;
+  int *dis_jchash, dis_jchashsize; // Open hash of destinations: 1 + index of a jumpcall there
   Dis_symbol *dis_symbols;
 
+  // Static variables from stats.c
+  struct stats *stats;          // Session statistics, NULL unless stats_enable() was called
+
   // Static variables from usb_libusb.c
 #include "usbdevs.h"
   char usb_buf[USBDEV_MAX_XFER_3];
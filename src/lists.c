@@ -82,6 +82,7 @@ typedef struct LIST {
 #endif
 
   int num;                      // Number of elements in the list
+  unsigned int stamp;           // Changes whenever the list is modified, see lstamp()
   short int free_on_close;      // Free the LIST memory on close T/F
   short int poolsize;           // List node allocation size
   int n_ln_pool;                // Number of listnodes in a pool
@@ -96,6 +97,9 @@ typedef struct LIST {
 #endif
 } LIST;
 
+// Last stamp handed out; stamps are unique across all lists
+static unsigned int lists_stamp;
+
 // Allocate list nodes in 512 byte chunks, giving 42 elements
 #define DEFAULT_POOLSIZE 512
 
@@ -421,6 +425,7 @@ LISTID lcreat(void *liststruct, int elements) {
   l->top = NULL;
   l->bottom = NULL;
   l->num = 0;
+  l->stamp = ++lists_stamp;
 
   if(elements == 0) {
     l->poolsize = DEFAULT_POOLSIZE;
@@ -548,6 +553,7 @@ int ladd(LISTID lid, void *p) {
     l->bottom = lnptr;
   }
   l->num++;
+  l->stamp = ++lists_stamp;
 
   CKLMAGIC(l);
 
@@ -670,6 +676,12 @@ int lsize(LISTID lid) {
   return ((LIST *) lid)->num;
 }
 
+// Return a stamp that changes whenever the list is modified and that no other list carries
+unsigned int lstamp(LISTID lid) {
+  CKLMAGIC(((LIST *) lid));
+  return ((LIST *) lid)->stamp;
+}
+
 /*------------------------------------------------------------
 |  lcat
 |
@@ -846,6 +858,7 @@ static int insert_ln(LIST *l, LISTNODE *ln, void *data_ptr) {
   }
 
   l->num++;
+  l->stamp = ++lists_stamp;
 
   CKLMAGIC(l);
 
@@ -1000,6 +1013,7 @@ static void *remove_ln(LIST *l, LISTNODE *ln) {
   |  adjust the item count of the list
    ------------------------------------*/
   l->num--;
+  l->stamp = ++lists_stamp;
 
   CKLMAGIC(l);
 
@@ -1187,6 +1201,7 @@ void lsort(LISTID lid, int (*compare)(void *p1, void *p2)) {
         ln->data = lt->data;
         lt->data = p;
         unsorted = 1;
+        l->stamp = ++lists_stamp;
       }
       lt = ln;
     }
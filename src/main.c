@@ -46,6 +46,7 @@
 
 #if !defined(WIN32)
 #include <dirent.h>
+#include <sys/wait.h>
 #endif
 
 #include "avrdude.h"
@@ -217,6 +218,8 @@ static LISTID extended_params = NULL;
 
 static LISTID additional_config_files = NULL;
 
+static LISTID gang_ports = NULL;        // All -P ports, programmed in parallel with -G
+
 static PROGRAMMER *pgm;
 
 // Global options
@@ -252,6 +255,7 @@ static void usage(void) {
     "  -D                     Disable auto-erase for flash memory; implies -A\n"
     "  -i <delay>             ISP Clock Delay [in microseconds]\n"
     "  -P <port>              Connection; -P ?s or -P ?sa lists serial ones\n"
+    "  -G                     Gang programming: program all -P ports in parallel\n"
     "  -r                     Reconnect to -P port after \"touching\" it; wait\n"
     "                         400 ms for each -r; needed for some USB boards\n"
     "  -F                     Override invalid signature or initial checks\n"
@@ -259,7 +263,7 @@ static void usage(void) {
     "  -O                     Perform RC oscillator calibration (see AVR053)\n"
     "  -t                     Run an interactive terminal when it is its turn\n"
     "  -T <terminal cmd line> Run terminal line when it is its turn\n"
-    "  -U <memstr>:r|w|v:<filename>[:format]\n"
+    "  -U <memstr>:r|w|v|d:<filename>[:format]\n"
     "                         Carry out memory operation when it is its turn\n"
     "                         Multiple -t, -T and -U options can be specified\n"
     "  -n                     Do not write to the device whilst processing -U\n"
@@ -269,6 +273,7 @@ static void usage(void) {
     "  -v                     Verbose output; -v -v for more\n"
     "  -q                     Quell progress output; -q -q for less\n"
     "  -l logfile             Use logfile rather than stderr for diagnostics\n"
+    "  -S statsfile           Write session statistics as JSON to statsfile\n"
     "  -?                     Display this usage\n"
     "\navrdude version %s, https://github.com/avrdudes/avrdude\n",
     progname, strlen(cfg) < 24? "config file ": "", cfg, AVRDUDE_FULL_VERSION);
@@ -474,6 +479,10 @@ static void cleanup_main(void) {
     ldestroy(additional_config_files);
     additional_config_files = NULL;
   }
+  if(gang_ports) {
+    ldestroy(gang_ports);
+    gang_ports = NULL;
+  }
 
   cleanup_config();
 }
@@ -669,6 +678,138 @@ static char *concatpath(char *dst, char *dir, char *file, size_t n) {
 
   return dst;
 }
+
+// Is fn the output file of a -U ...:r: option (other than stdout)?
+static int gang_is_output(const char *fn) {
+  if(fn && !str_eq(fn, "-"))
+    for(LNODEID ln = lfirst(updates); ln; ln = lnext(ln)) {
+      UPDATE *upd = ldata(ln);
+
+      if(!upd->cmdline && upd->op == DEVICE_READ && upd->filename && str_eq(upd->filename, fn))
+        return 1;
+    }
+
+  return 0;
+}
+
+// Decode -U input files once so the forked targets find the images in the file cache
+static void gang_decode_inputs(void) {
+  AVRPART *p = partdesc && *partdesc? locate_part(part_list, partdesc): NULL;
+
+  if(p)                         // Otherwise each target reports the problem in its log
+    for(LNODEID ln = lfirst(updates); ln; ln = lnext(ln)) {
+      UPDATE upd = *(UPDATE *) ldata(ln);
+
+      if(!upd.memstr)
+        upd.memstr = is_pdi(p)? "application": "flash";
+      if(!gang_is_output(upd.filename))        // Written per target later on
+        update_decode_input(p, &upd);
+    }
+}
+
+// Rename -U output files of target n to <file>.<n>, also where they are read back
+static void gang_rename_outputs(int n) {
+  int nr = 0;
+  char **outputs = mmt_malloc(lsize(updates)*sizeof *outputs);
+
+  for(LNODEID ln = lfirst(updates); ln; ln = lnext(ln)) {
+    UPDATE *upd = ldata(ln);
+
+    if(!upd->cmdline && upd->op == DEVICE_READ && upd->filename && !str_eq(upd->filename, "-"))
+      outputs[nr++] = mmt_strdup(upd->filename);
+  }
+  for(LNODEID ln = lfirst(updates); ln; ln = lnext(ln)) {
+    UPDATE *upd = ldata(ln);
+
+    for(int i = 0; i < nr; i++)
+      if(upd->filename && str_eq(upd->filename, outputs[i])) {
+        char *old = upd->filename;
+
+        upd->filename = mmt_sprintf("%s.%d", old, n);
+        mmt_free(old);
+        break;
+      }
+  }
+  for(int i = 0; i < nr; i++)
+    mmt_free(outputs[i]);
+  mmt_free(outputs);
+}
+
+/*
+ * Gang programming with -G: carry out the programming once for each -P port,
+ * each in its own process forked after avrdude.conf and the command line
+ * have been processed and the -U input files have been decoded. Target n
+ * writes its diagnostics and standard output to <logfile>.<n>, where logfile
+ * defaults to avrdude.log, and -U ...:r: output files to <file>.<n>.
+ * Statistics, if requested, go to <statsfile>.<n>. The parent waits for all
+ * targets, summarises the outcome and exits. Only returns in the child
+ * processes after having set *portp to the port of the target.
+ */
+static void gang_programming(char **portp, const char *logfile, const char **statsp) {
+  int n = 0, nports = lsize(gang_ports), nfail = 0;
+  pid_t *pids = mmt_malloc(nports*sizeof *pids);
+  const char **ports = mmt_malloc(nports*sizeof *ports);
+
+  if(!logfile)
+    logfile = mmt_sprintf("%s.log", progname);
+  pmsg_info("gang programming %d targets, see %s.<n> for the log of target n\n", nports, logfile);
+
+  for(LNODEID ln = lfirst(gang_ports); ln; ln = lnext(ln), n++) {
+    ports[n] = ldata(ln);
+    fflush(stdout);
+    fflush(stderr);
+    if((pids[n] = fork()) < 0) {
+      pmsg_ext_error("cannot fork process for port %s: %s\n", ports[n], strerror(errno));
+      nfail++;
+    } else if(pids[n] == 0) {   // Child: carry on with the programming of this target
+      char *log = mmt_sprintf("%s.%d", logfile, n + 1);
+
+      if(!freopen(log, "w", stderr)) {
+        printf("Cannot create logfile %s: %s\n", log, strerror(errno));
+        exit(1);
+      }
+      setvbuf(stderr, (char *) NULL, _IOLBF, 0);
+      if(dup2(fileno(stderr), fileno(stdout)) < 0) {
+        fprintf(stderr, "Cannot redirect stdout to logfile %s: %s\n", log, strerror(errno));
+        exit(1);
+      }
+      setvbuf(stdout, (char *) NULL, _IOLBF, 0);
+      mmt_free(log);
+      gang_rename_outputs(n + 1);
+      if(*statsp && !str_eq(*statsp, "-"))
+        *statsp = mmt_sprintf("%s.%d", *statsp, n + 1);
+      *portp = mmt_strdup(ports[n]);
+      mmt_free(pids);
+      mmt_free(ports);
+      return;
+    }
+  }
+
+  for(int i = 0; i < nports; i++) {
+    int status = 0;
+
+    if(pids[i] < 0)
+      continue;
+    if(waitpid(pids[i], &status, 0) < 0) {
+      pmsg_ext_error("cannot wait for target %d: %s\n", i + 1, strerror(errno));
+      nfail++;
+    } else if(WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+      pmsg_info("target %d on %s succeeded\n", i + 1, ports[i]);
+    } else {
+      if(WIFEXITED(status))
+        pmsg_error("target %d on %s failed with exit code %d\n", i + 1, ports[i], WEXITSTATUS(status));
+      else
+        pmsg_error("target %d on %s terminated by signal %d\n", i + 1, ports[i],
+          WIFSIGNALED(status)? WTERMSIG(status): 0);
+      nfail++;
+    }
+  }
+  pmsg_info("%d of %d target%s programmed successfully\n", nports - nfail, nports, str_plural(nports));
+
+  mmt_free(pids);
+  mmt_free(ports);
+  exit(nfail? 1: 0);
+}
 #endif
 
 
@@ -692,6 +833,7 @@ int main(int argc, char *argv[]) {
   const char *exitspecs;        // Exit specs string from command line
   int explicit_c;               // 1=explicit -c on command line, 0=not specified there
   int explicit_e;               // 1=explicit -e on command line, 0=not specified there
+  int gang;                     // 1=program all -P ports in parallel, 0=last -P wins
   char sys_config[PATH_MAX];    // System wide config file
   char executable_abspath[PATH_MAX];     // Absolute path to avrdude executable
   char executable_dirpath[PATH_MAX];     // Absolute path to folder with executable
@@ -707,6 +849,7 @@ int main(int argc, char *argv[]) {
   int is_open;                  // Device open succeeded
   int ce_delayed;               // Chip erase delayed
   char *logfile;                // Use logfile rather than stderr for diagnostics
+  const char *statsfile;        // Write session statistics as JSON to this file
   enum updateflags uflags = UF_AUTO_ERASE | UF_VERIFY;  // Flags for do_op()
 
   init_cx(NULL);
@@ -773,6 +916,12 @@ int main(int argc, char *argv[]) {
     exit(1);
   }
 
+  gang_ports = lcreat(NULL, 0);
+  if(gang_ports == NULL) {
+    pmsg_error("cannot initialize port list\n");
+    exit(1);
+  }
+
   partdesc = NULL;
   port = NULL;
   erase = 0;
@@ -787,6 +936,7 @@ int main(int argc, char *argv[]) {
   pgmid = "";
   explicit_c = 0;
   explicit_e = 0;
+  gang = 0;
   verbose = 0;
   baudrate = 0;
   touch_1200bps = 0;
@@ -795,6 +945,7 @@ int main(int argc, char *argv[]) {
   is_open = 0;
   ce_delayed = 0;
   logfile = NULL;
+  statsfile = NULL;
 
   if(argc == 1) {               // No arguments?
     usage();
@@ -814,7 +965,7 @@ int main(int argc, char *argv[]) {
 #endif
 
   // Process command line arguments
-  while((ch = getopt(argc, argv, "?Ab:B:c:C:DeE:Fi:l:nNp:OP:qrtT:U:vVx:")) != -1) {
+  while((ch = getopt(argc, argv, "?Ab:B:c:C:DeE:FGi:l:nNp:OP:qrS:tT:U:vVx:")) != -1) {
     switch(ch) {
     case 'b':                  // Override default programmer baud rate
       baudrate = str_int(optarg, STR_INT32, &errstr);
@@ -902,6 +1053,11 @@ int main(int argc, char *argv[]) {
       uflags |= UF_NOWRITE;
       break;
 
+    case 'S':
+      statsfile = optarg;
+      stats_enable();
+      break;
+
     case 'N':
       no_avrduderc = 1;
       break;
@@ -914,8 +1070,13 @@ int main(int argc, char *argv[]) {
       partdesc = optarg;
       break;
 
+    case 'G':                  // Gang programming of all -P ports
+      gang = 1;
+      break;
+
     case 'P':
       port = mmt_strdup(optarg);
+      ladd(gang_ports, optarg);
       break;
 
     case 'q':                  // Quell progress output
@@ -1142,6 +1303,7 @@ int main(int argc, char *argv[]) {
   for(LNODEID ln1 = lfirst(part_list); ln1; ln1 = lnext(ln1))
     if((p = ldata(ln1))->mem)
       lsort(p->mem, avr_mem_cmp);
+  avr_index_invalidate();
 
   // Set bitclock from configuration files unless changed by command line
   if(default_bitclock > 0 && bitclock == 0.0) {
@@ -1341,6 +1503,17 @@ int main(int argc, char *argv[]) {
     exit(1);
   }
 
+  if(gang && lsize(gang_ports) > 1) {
+
+#if !defined(WIN32)
+    gang_decode_inputs();
+    gang_programming(&port, logfile, &statsfile);   // Only returns in the child process for each port
+#else
+    pmsg_error("gang programming with -G is not supported on Windows\n");
+    exit(1);
+#endif
+  }
+
   /*
    * Divide a serialadapter port string into tokens separated by colons.
    * There are two ways such a port string can be presented:
@@ -1440,7 +1613,9 @@ int main(int argc, char *argv[]) {
     pgm->ispdelay = ispdelay;
   }
 
+  stats_begin("connect", NULL);
   rc = pgm->open(pgm, port);
+  stats_end();
   if(rc < 0) {
     if(rc == LIBAVRDUDE_EXIT) {
       exitrc = 0;
@@ -1524,7 +1699,8 @@ int main(int argc, char *argv[]) {
       const char *mtype = is_pdi(p)? "application": "flash";
 
       pmsg_notice2("defaulting memstr in -U %c:%s option to \"%s\"\n",
-        (upd->op == DEVICE_READ)? 'r': (upd->op == DEVICE_WRITE)? 'w': 'v', upd->filename, mtype);
+        (upd->op == DEVICE_READ)? 'r': (upd->op == DEVICE_WRITE)? 'w': (upd->op == DEVICE_VERIFY)? 'v': 'd',
+        upd->filename, mtype);
       upd->memstr = mmt_strdup(mtype);
     }
     rc = update_dryrun(p, upd);
@@ -1564,6 +1740,7 @@ int main(int argc, char *argv[]) {
   exitrc = 0;
 
   // Enable the programmer
+  stats_begin("initialize", NULL);
   pgm->enable(pgm, p);
 
   // Turn off all the status LEDs and reset LED states
@@ -1571,6 +1748,7 @@ int main(int argc, char *argv[]) {
 
   // Initialize the chip in preparation for accepting commands
   init_ok = (rc = pgm->initialize(pgm, p)) >= 0;
+  stats_end();
   if(!init_ok) {
     if(rc == LIBAVRDUDE_EXIT) {
       exitrc = 0;
@@ -1615,7 +1793,9 @@ int main(int argc, char *argv[]) {
   sig_again:
     usleep(waittime);
     if(init_ok) {
+      stats_begin("signature", NULL);
       rc = avr_signature(pgm, p);
+      stats_end();
       if(rc == LIBAVRDUDE_EXIT) {
         exitrc = 0;
         goto main_exit;
@@ -1750,8 +1930,8 @@ int main(int argc, char *argv[]) {
         if(upd->cmdline && *str_ltrim(upd->cmdline) && str_starts("erase", str_ltrim(upd->cmdline)))
           break;                // -T erase already erases the chip: no auto-erase needed
 
-        if(upd->cmdline || (upd->memstr &&      // Might be reading flash?
-            (upd->op == DEVICE_READ || upd->op == DEVICE_VERIFY) && memlist_contains_flash(upd->memstr, p)))
+        if(upd->cmdline || (upd->memstr &&      // Might be reading flash? Delta writes compare with it
+            upd->op != DEVICE_WRITE && memlist_contains_flash(upd->memstr, p)))
           flashread = 1;
 
         if(upd->memstr && upd->op == DEVICE_WRITE && memlist_contains_flash(upd->memstr, p)) {
@@ -1779,7 +1959,9 @@ int main(int argc, char *argv[]) {
       else
         pmsg_notice("-n specified, NOT erasing chip\n");
     } else {
+      stats_begin("chip_erase", NULL);
       exitrc = avr_chip_erase(pgm, p);
+      stats_end();
       if(exitrc == LIBAVRDUDE_SOFTFAIL) {
         pmsg_notice("delaying chip erase until first -U upload to flash\n");
         ce_delayed = 1;
@@ -1810,7 +1992,7 @@ int main(int argc, char *argv[]) {
       pgm->reset_cache(pgm, p);
     } else if(!upd->cmdline) {  // Flush cache before any device memory access
       pgm->flush_cache(pgm, p);
-      wrmem |= upd->op == DEVICE_WRITE;
+      wrmem |= upd->op == DEVICE_WRITE || upd->op == DEVICE_DELTA;
     }
     if((uflags & UF_NOWRITE) && upd->cmdline && !terminal++)
       pmsg_warning("the terminal ignores option -n, that is, it writes to the device\n");
@@ -1833,11 +2015,16 @@ main_exit:
   if(is_open) {
     // Clear rdy LED and summarise interaction in err, pgm and vfy LEDs
     led_set(pgm, LED_END);
+    stats_begin("close", NULL);
     pgm->powerdown(pgm);
     pgm->disable(pgm);
     pgm->close(pgm);
+    stats_end();
   }
 
+  if(statsfile)
+    stats_json(statsfile, pgmid, p? p->desc: partdesc);
+
   if(cx->usb_access_error) {
     pmsg_info("\nUSB access errors detected; this could have many reasons; if it is\n"
       "USB permission problems, avrdude is likely to work when run as root\n"
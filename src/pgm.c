@@ -95,6 +95,10 @@ void pgm_init_functions(PROGRAMMER *pgm) {
   pgm->spi = NULL;
   pgm->paged_write = NULL;
   pgm->paged_load = NULL;
+  pgm->paged_load_async = NULL;
+  pgm->paged_load_collect = NULL;
+  pgm->paged_write_async = NULL;
+  pgm->paged_write_collect = NULL;
   pgm->page_erase = NULL;
   pgm->write_setup = NULL;
   pgm->read_sig_bytes = NULL;
@@ -32,6 +32,7 @@
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/select.h>
+#include <time.h>
 #include <sys/socket.h>
 #include <netdb.h>
 
@@ -351,6 +352,10 @@ static int ser_set_dtr_rts(const union filedescriptor *fdp, int is_on) {
 
   r = ioctl(fdp->ifd, TIOCMGET, &ctl);
   if(r < 0) {
+    if(errno == ENOTTY || errno == EINVAL) {    // Pseudo terminals have no modem lines
+      pmsg_debug("ioctl(\"TIOCMGET\"): %s; ignoring DTR/RTS\n", strerror(errno));
+      return 0;
+    }
     pmsg_ext_error("ioctl(\"TIOCMGET\"): %s\n", strerror(errno));
     return -1;
   }
@@ -372,6 +377,42 @@ static int ser_set_dtr_rts(const union filedescriptor *fdp, int is_on) {
   return 0;
 }
 
+// Receive buffer of port fd; if new is set, claim one that holds no data for another port
+static Ser_rxbuf *ser_rxbuf(int fd, int new) {
+  Ser_rxbuf *rb = cx->ser_rx, *avail = NULL;
+
+  for(int i = 0; i < SER_RXBUFS; i++, rb++) {
+    if(rb->used && rb->fd == fd)
+      return rb;
+    if(!avail && (!rb->used || !rb->len))
+      avail = rb;
+  }
+  if(new && avail) {
+    avail->used = 1, avail->fd = fd;
+    avail->head = avail->len = 0;
+    return avail;
+  }
+
+  return NULL;
+}
+
+// Discard receive data buffered for port fd, leaving that of other ports alone
+static void ser_rxreset(int fd) {
+  Ser_rxbuf *rb = ser_rxbuf(fd, 0);
+
+  if(rb)
+    rb->used = 0, rb->head = rb->len = 0;
+}
+
+// Monotonic ms timestamp unaffected by changes of the wall clock
+static long long ser_ms_now(void) {
+  struct timespec ts;
+
+  if(clock_gettime(CLOCK_MONOTONIC, &ts) < 0)
+    return avr_mstimestamp();
+  return ts.tv_sec*1000LL + ts.tv_nsec/1000000;
+}
+
 static int ser_open(const char *port, union pinfo pinfo, union filedescriptor *fdp) {
   int rc;
   int fd;
@@ -381,7 +422,9 @@ static int ser_open(const char *port, union pinfo pinfo, union filedescriptor *f
    * connection to a terminal server.
    */
   if(str_starts(port, "net:")) {
-    return net_open(port + strlen("net:"), fdp);
+    if((rc = net_open(port + strlen("net:"), fdp)) == 0)
+      ser_rxreset(fdp->ifd);    // Descriptor may be reused: drop stale buffered data
+    return rc;
   }
 
   // Open the serial port
@@ -392,6 +435,7 @@ static int ser_open(const char *port, union pinfo pinfo, union filedescriptor *f
   }
 
   fdp->ifd = fd;
+  ser_rxreset(fd);
 
   // Set serial line attributes
   rc = ser_setparams(fdp, pinfo.serialinfo.baud, pinfo.serialinfo.cflags);
@@ -413,12 +457,14 @@ static void ser_close(union filedescriptor *fd) {
     cx->ser_saved_original_termios = 0;
   }
 
+  ser_rxreset(fd->ifd);
   close(fd->ifd);
 }
 
 // Close but don't restore attributes
 static void ser_rawclose(union filedescriptor *fd) {
   cx->ser_saved_original_termios = 0;
+  ser_rxreset(fd->ifd);
   close(fd->ifd);
 }
 
@@ -441,20 +487,34 @@ static int ser_send(const union filedescriptor *fd, const unsigned char *buf, si
   return 0;
 }
 
+/*
+ * Receive exactly buflen bytes within serial_recv_timeout ms. Whatever the
+ * kernel has available is read in one go into the buffer of the port, so the
+ * many small requests of the programmer drivers are mostly served from memory.
+ */
 static int ser_recv(const union filedescriptor *fd, unsigned char *buf, size_t buflen) {
-  struct timeval timeout, to2;
+  struct timeval to2;
   fd_set rfds;
-  int nfds;
-  int rc;
-  unsigned char *p = buf;
-  size_t len = 0;
-
-  timeout.tv_sec = serial_recv_timeout/1000L;
-  timeout.tv_usec = (serial_recv_timeout%1000L)*1000;
-  to2 = timeout;
+  int nfds, nzero = 0;
+  ssize_t rc;
+  size_t n, len = 0;
+  long long left, deadline = ser_ms_now() + serial_recv_timeout;
+  Ser_rxbuf *rb = ser_rxbuf(fd->ifd, 1);        // NULL: all buffers hold data of other ports
 
   while(len < buflen) {
-  reselect:
+    if(rb && rb->len) {         // Serve from buffer
+      n = buflen - len < rb->len? buflen - len: rb->len;
+      memcpy(buf + len, rb->buf + rb->head, n);
+      rb->head += n;
+      rb->len -= n;
+      len += n;
+      continue;
+    }
+
+    if((left = deadline - ser_ms_now()) < 0)
+      left = 0;
+    to2.tv_sec = left/1000;
+    to2.tv_usec = (left%1000)*1000;
     FD_ZERO(&rfds);
     FD_SET(fd->ifd, &rfds);
 
@@ -465,19 +525,37 @@ static int ser_recv(const union filedescriptor *fd, unsigned char *buf, size_t b
     } else if(nfds == -1) {
       if(errno == EINTR || errno == EAGAIN) {
         pmsg_warning("programmer is not responding, reselecting\n");
-        goto reselect;
+        continue;
       } else {
         pmsg_ext_error("select(): %s\n", strerror(errno));
         return -1;
       }
     }
 
-    rc = read(fd->ifd, p, buflen - len > 1024? 1024: buflen - len);
+    // Large requests go straight to the caller, small ones via the buffer
+    if(!rb || buflen - len >= sizeof rb->buf)
+      rc = read(fd->ifd, buf + len, buflen - len);
+    else if((rc = read(fd->ifd, rb->buf, sizeof rb->buf)) > 0)
+      rb->head = 0, rb->len = rc, rc = 0;
     if(rc < 0) {
+      if(errno == EAGAIN || errno == EINTR)
+        continue;
       pmsg_ext_error("unable to read: %s\n", strerror(errno));
       return -1;
     }
-    p += rc;
+    if(rc == 0 && !(rb && rb->len)) {
+      /*
+       * Nothing read although select() said the line was readable: go back
+       * to select() once; a second empty read means end of file (hang-up or
+       * closed socket), which would otherwise spin until the deadline
+       */
+      if(nzero++ || !left) {
+        pmsg_notice2("%s(): programmer is not responding\n", __func__);
+        return -1;
+      }
+      continue;
+    }
+    nzero = 0;
     len += rc;
   }
 
@@ -493,6 +571,7 @@ static int ser_drain(const union filedescriptor *fd, int display) {
   int nfds;
   int rc;
   unsigned char buf;
+  Ser_rxbuf *rb = ser_rxbuf(fd->ifd, 0);
 
   timeout.tv_sec = 0;
   timeout.tv_usec = serial_drain_timeout*1000L;
@@ -501,6 +580,12 @@ static int ser_drain(const union filedescriptor *fd, int display) {
     msg_info("drain>");
   }
 
+  // Discard bytes that were read ahead from this port
+  if(rb && display)
+    for(size_t i = 0; i < rb->len; i++)
+      msg_info("%02x ", rb->buf[rb->head + i]);
+  ser_rxreset(fd->ifd);
+
   while(1) {
     FD_ZERO(&rfds);
     FD_SET(fd->ifd, &rfds);
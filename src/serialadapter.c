@@ -369,6 +369,20 @@ int touch_serialport(char **portp, int baudrate, int nwaits) {
   return 0;
 }
 
+// Set USB vid and pid of a serial port; return 0 on success and -1 if not a USB port
+int serialport_vid_pid(const char *port, int *vidp, int *pidp) {
+  struct sp_port *p;
+  int rv = -1;
+
+  if(!port || sp_get_port_by_name(port, &p) != SP_OK)
+    return -1;
+  if(sp_get_port_transport(p) == SP_TRANSPORT_USB && sp_get_port_usb_vid_pid(p, vidp, pidp) == SP_OK)
+    rv = 0;
+  sp_free_port(p);
+
+  return rv;
+}
+
 // List available serial ports
 int list_available_serialports(LISTID programmers) {
   // Get serial port information from libserialport
@@ -405,6 +419,10 @@ int setport_from_vid_pid(char **portp, int vid, int pid, const char *sernum) {
   return -1;
 }
 
+int serialport_vid_pid(const char *port, int *vidp, int *pidp) {
+  return -1;
+}
+
 int list_available_serialports(LISTID programmers) {
   pmsg_error("avrdude built without libserialport support; please compile again with libserialport installed\n");
   return -1;
@@ -57,8 +57,36 @@ static void serialupdi_teardown(PROGRAMMER *pgm) {
   pgm->cookie = NULL;
 }
 
+// Serial adapters known to lose data on long writes and the RSD block size that works for them
+static const struct {
+  int vid, pid, blocksize;
+  const char *name;
+} rsd_adapters[] = {
+  {0x1a86, 0x7523, 32, "CH340"},
+  {0x1a86, 0x5523, 32, "CH341"},
+};
+
+// Choose the RSD burst block size for the serial adapter at the port unless set by -x rsd=...
+static void serialupdi_tune_rsd(const PROGRAMMER *pgm) {
+  int vid, pid;
+
+  if(updi_get_rsd_mode(pgm) != RSD_MODE_AUTO)
+    return;
+  updi_set_rsd_mode(pgm, RSD_MODE_ON);
+  updi_set_rsd_blocksize(pgm, 0);
+  if(serialport_vid_pid(pgm->port, &vid, &pid) < 0)
+    return;
+  for(size_t i = 0; i < sizeof rsd_adapters/sizeof *rsd_adapters; i++)
+    if(rsd_adapters[i].vid == vid && rsd_adapters[i].pid == pid) {
+      updi_set_rsd_blocksize(pgm, rsd_adapters[i].blocksize);
+      pmsg_notice2("%s adapter: sending RSD bursts in blocks of %d bytes\n", rsd_adapters[i].name,
+        rsd_adapters[i].blocksize);
+    }
+}
+
 static int serialupdi_open(PROGRAMMER *pgm, const char *port) {
   pgm->port = port;
+  serialupdi_tune_rsd(pgm);
   return updi_link_open(pgm);
 }
 
@@ -177,6 +205,7 @@ static int serialupdi_decode_sib(const PROGRAMMER *pgm, updi_sib_info *sib_info)
 }
 
 static void serialupdi_close(PROGRAMMER *pgm) {
+  updi_nvm_report(pgm);
   pmsg_notice("leaving NVM programming mode\n");
 
   if(serialupdi_leave_progmode(pgm) < 0) {
@@ -536,7 +565,7 @@ static int serialupdi_write_userrow(const PROGRAMMER *pgm, const AVRPART *p, con
   }
 
   if(n_bytes <= UPDI_MAX_REPEAT_SIZE) {
-    if(updi_write_data(pgm, m->offset + addr, m->buf + addr, n_bytes) < 0) {
+    if(updi_write_data_RSD(pgm, m->offset + addr, m->buf + addr, n_bytes) < 0) {
       pmsg_error("writing USER ROW failed\n");
       return -1;
     }
@@ -1023,6 +1052,30 @@ static int serialupdi_parseextparms(const PROGRAMMER *pgm, const LISTID extparms
       continue;
     }
 
+    if(str_starts(extended_param, "rsd=")) {
+      const char *arg = extended_param + 4, *errptr;
+      int blocksize;
+
+      if(str_caseeq(arg, "auto")) {
+        updi_set_rsd_mode(pgm, RSD_MODE_AUTO);
+      } else if(str_caseeq(arg, "off")) {
+        updi_set_rsd_mode(pgm, RSD_MODE_OFF);
+      } else if(str_caseeq(arg, "on")) {
+        updi_set_rsd_mode(pgm, RSD_MODE_ON);
+        updi_set_rsd_blocksize(pgm, 0);
+      } else {
+        blocksize = str_int(arg, STR_INT32, &errptr);
+        if(errptr || blocksize <= 0) {
+          pmsg_error("-x rsd=<arg>: arg must be auto, on, off or a positive block size\n");
+          rv = -1;
+          break;
+        }
+        updi_set_rsd_mode(pgm, RSD_MODE_ON);
+        updi_set_rsd_blocksize(pgm, blocksize);
+      }
+      continue;
+    }
+
     if(str_eq(extended_param, "help")) {
       help = true;
       rv = LIBAVRDUDE_EXIT;
@@ -1034,6 +1087,9 @@ static int serialupdi_parseextparms(const PROGRAMMER *pgm, const LISTID extparms
     }
     msg_error("%s -c %s extended options:\n", progname, pgmid);
     msg_error("  -x rtsdtr=[low|high] Set RTS/DTR lines low/high during programming\n");
+    msg_error("  -x rsd=auto          Write in RSD bursts, block size chosen for adapter (default)\n");
+    msg_error("  -x rsd=on|<n>        Write in RSD bursts sent all at once or in blocks of n bytes\n");
+    msg_error("  -x rsd=off           Wait for an ACK after every byte written\n");
     msg_error("  -x help              Show this help menu and exit\n");
     return rv;
   }
@@ -0,0 +1,262 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Session statistics: time spent in the phases of a session (connecting,
+ * initialising, reading the signature, reading/writing/verifying each
+ * memory), pages and bytes moved per memory, bytes sent to and received
+ * from serial and USB serial devices and a histogram of command round-trip
+ * times. Nothing is recorded unless stats_enable() has been called.
+ */
+
+#include <ac_cfg.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "avrdude.h"
+#include "libavrdude.h"
+
+#define STATS_NHIST 32          // Round-trip histogram bucket k counts times in [2^(k-1), 2^k) us
+
+typedef struct {
+  const char *name, *memory;    // Phase name and memory (or NULL)
+  int count;                    // How often the phase was entered
+  uint64_t us;                  // Total time spent in it
+} Stats_phase;
+
+typedef struct {
+  const char *memory;
+  long pages[2], bytes[2];      // Index 0 for reads, 1 for writes
+} Stats_memory;
+
+struct stats {
+  uint64_t t_start;             // Start of the session
+  Stats_phase *phases;
+  int nphases, current;         // Index of the current phase or -1
+  uint64_t t_phase;             // Start of the current phase
+  Stats_memory *mems;
+  int nmems;
+  long nsend, nrecv;            // Number of send and receive calls
+  long long sent, received;     // Bytes sent and received
+  int pending;                  // Has there been a send since the last receive?
+  uint64_t t_send;              // Time of last send
+  long nrtt;                    // Round trips measured
+  uint64_t rtt_min, rtt_max, rtt_sum;
+  long hist[STATS_NHIST];
+};
+
+#define st (cx->stats)
+
+// Start recording statistics for this session
+void stats_enable(void) {
+  if(!st) {
+    st = mmt_malloc(sizeof *st);
+    st->current = -1;
+    st->t_start = avr_ustimestamp();
+  }
+}
+
+// End the current phase, if any
+void stats_end(void) {
+  if(st && st->current >= 0) {
+    st->phases[st->current].us += avr_ustimestamp() - st->t_phase;
+    st->current = -1;
+  }
+}
+
+// Start timing a new phase, eg, "write" of memory "flash"; ends the current phase
+void stats_begin(const char *name, const char *memory) {
+  int i;
+
+  if(!st)
+    return;
+  stats_end();
+  for(i = 0; i < st->nphases; i++)
+    if(str_eq(st->phases[i].name, name) && (memory? st->phases[i].memory &&
+      str_eq(st->phases[i].memory, memory): !st->phases[i].memory))
+      break;
+  if(i == st->nphases) {
+    st->phases = mmt_realloc(st->phases, (st->nphases + 1)*sizeof *st->phases);
+    st->phases[i] = (Stats_phase) { cache_string(name), memory? cache_string(memory): NULL, 0, 0 };
+    st->nphases++;
+  }
+  st->phases[i].count++;
+  st->current = i;
+  st->t_phase = avr_ustimestamp();
+}
+
+// Record that pages (0 for byte access) and bytes of a memory were read or written
+void stats_memory(const char *memory, int write, int pages, int bytes) {
+  int i;
+
+  if(!st)
+    return;
+  for(i = 0; i < st->nmems; i++)
+    if(str_eq(st->mems[i].memory, memory))
+      break;
+  if(i == st->nmems) {
+    st->mems = mmt_realloc(st->mems, (st->nmems + 1)*sizeof *st->mems);
+    st->mems[i] = (Stats_memory) { cache_string(memory), {0, 0}, {0, 0} };
+    st->nmems++;
+  }
+  st->mems[i].pages[!!write] += pages;
+  st->mems[i].bytes[!!write] += bytes;
+}
+
+// Bucket of a round-trip time: number of significant bits of us
+static int stats_bucket(uint64_t us) {
+  int k = 0;
+
+  for(; us && k < STATS_NHIST - 1; us >>= 1)
+    k++;
+
+  return k;
+}
+
+// Counting replacement for serdev->send(), see serial_send()
+int stats_serial_send(const union filedescriptor *fd, const unsigned char *buf, size_t len) {
+  int rc = serdev->send(fd, buf, len);
+
+  if(st && rc >= 0) {
+    st->nsend++;
+    st->sent += len;
+    st->t_send = avr_ustimestamp();
+    st->pending = 1;
+  }
+
+  return rc;
+}
+
+// Counting replacement for serdev->recv(); the first receive after a send closes a round trip
+int stats_serial_recv(const union filedescriptor *fd, unsigned char *buf, size_t len) {
+  int rc = serdev->recv(fd, buf, len);
+
+  if(st && rc >= 0) {
+    st->nrecv++;
+    st->received += len;
+    if(st->pending) {
+      uint64_t rtt = avr_ustimestamp() - st->t_send;
+
+      if(!st->nrtt || rtt < st->rtt_min)
+        st->rtt_min = rtt;
+      if(rtt > st->rtt_max)
+        st->rtt_max = rtt;
+      st->rtt_sum += rtt;
+      st->nrtt++;
+      st->hist[stats_bucket(rtt)]++;
+      st->pending = 0;
+    }
+  }
+
+  return rc;
+}
+
+// Print s as JSON string
+static void stats_str(FILE *f, const char *s) {
+  putc('"', f);
+  for(; s && *s; s++)
+    if(*s == '"' || *s == '\\')
+      fprintf(f, "\\%c", *s);
+    else if((unsigned char) *s < ' ')
+      fprintf(f, "\\u%04x", *s);
+    else
+      putc(*s, f);
+  putc('"', f);
+}
+
+// Stop recording and release the statistics of this session
+static void stats_free(void) {
+  if(st) {
+    mmt_free(st->phases);
+    mmt_free(st->mems);
+    mmt_free(st);
+    st = NULL;
+  }
+}
+
+// Write statistics as JSON object to file fname ("-" for stdout) and free them; returns 0 on success
+int stats_json(const char *fname, const char *programmer, const char *part) {
+  FILE *f;
+
+  if(!st)
+    return -1;
+  stats_end();
+
+  if(!(f = str_eq(fname, "-")? stdout: fopen(fname, "w"))) {
+    pmsg_ext_error("cannot write statistics to %s: %s\n", fname, strerror(errno));
+    stats_free();
+    return -1;
+  }
+
+  fprintf(f, "{\n  \"programmer\": ");
+  stats_str(f, programmer);
+  fprintf(f, ",\n  \"part\": ");
+  stats_str(f, part);
+  fprintf(f, ",\n  \"seconds\": %.6f,\n", (avr_ustimestamp() - st->t_start)/1e6);
+
+  fprintf(f, "  \"phases\": [");
+  for(int i = 0; i < st->nphases; i++) {
+    fprintf(f, "%s\n    {\"phase\": ", i? ",": "");
+    stats_str(f, st->phases[i].name);
+    if(st->phases[i].memory) {
+      fprintf(f, ", \"memory\": ");
+      stats_str(f, st->phases[i].memory);
+    }
+    fprintf(f, ", \"count\": %d, \"seconds\": %.6f}", st->phases[i].count, st->phases[i].us/1e6);
+  }
+  fprintf(f, "%s],\n", st->nphases? "\n  ": "");
+
+  fprintf(f, "  \"memories\": [");
+  for(int i = 0; i < st->nmems; i++) {
+    fprintf(f, "%s\n    {\"memory\": ", i? ",": "");
+    stats_str(f, st->mems[i].memory);
+    fprintf(f, ", \"pages_read\": %ld, \"bytes_read\": %ld, \"pages_written\": %ld, \"bytes_written\": %ld}",
+      st->mems[i].pages[0], st->mems[i].bytes[0], st->mems[i].pages[1], st->mems[i].bytes[1]);
+  }
+  fprintf(f, "%s],\n", st->nmems? "\n  ": "");
+
+  fprintf(f, "  \"io\": {\"sends\": %ld, \"bytes_sent\": %lld, \"receives\": %ld, \"bytes_received\": %lld},\n",
+    st->nsend, st->sent, st->nrecv, st->received);
+
+  fprintf(f, "  \"round_trips\": {\"count\": %ld", st->nrtt);
+  if(st->nrtt)
+    fprintf(f, ", \"min_us\": %llu, \"max_us\": %llu, \"mean_us\": %.1f",
+      (unsigned long long) st->rtt_min, (unsigned long long) st->rtt_max, (double) st->rtt_sum/st->nrtt);
+  fprintf(f, ",\n    \"histogram\": [");
+  for(int k = 0, first = 1; k < STATS_NHIST; k++)
+    if(st->hist[k]) {
+      fprintf(f, "%s{\"below_us\": %llu, \"count\": %ld}", first? "": ", ", 1ULL << k, st->hist[k]);
+      first = 0;
+    }
+  fprintf(f, "]}\n}\n");
+
+  int rc = ferror(f)? -1: 0;
+
+  if(f != stdout)
+    rc |= fclose(f);
+  else
+    fflush(f);
+  if(rc)
+    pmsg_error("cannot write statistics to %s\n", fname);
+  stats_free();
+
+  return rc? -1: 0;
+}
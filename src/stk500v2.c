@@ -479,7 +479,7 @@ static int stk500v2_send(const PROGRAMMER *pgm, unsigned char *data, size_t len)
     return stk500v2_jtag3_send(pgm, data, len);
 
   buf[0] = MESSAGE_START;
-  buf[1] = my.command_sequence;
+  buf[1] = my.command_sequence + my.rq_n; // Skip sequence numbers of pipelined requests in flight
   buf[2] = len/256;
   buf[3] = len%256;
   buf[4] = TOKEN;
@@ -1876,6 +1876,32 @@ static int stk500v2_parseextparms(const PROGRAMMER *pgm, const LISTID extparms)
       }
     }
 
+    if(str_starts(extended_param, "readwindow=") && pgm->paged_load_async) {
+      const char *errstr;
+      int n = str_int(extended_param + strlen("readwindow="), STR_INT32, &errstr);
+
+      if(errstr || n < 1 || n > STK500V2_MAX_WINDOW) {
+        pmsg_error("invalid value in -x %s%s%s\n", extended_param, errstr? ": ": "", errstr? errstr: "");
+        rv = -1;
+        break;
+      }
+      my.read_window = n;
+      continue;
+    }
+
+    if(str_starts(extended_param, "writewindow=") && pgm->paged_write_async) {
+      const char *errstr;
+      int n = str_int(extended_param + strlen("writewindow="), STR_INT32, &errstr);
+
+      if(errstr || n < 1 || n > STK500V2_MAX_WINDOW/2) {
+        pmsg_error("invalid value in -x %s%s%s\n", extended_param, errstr? ": ": "", errstr? errstr: "");
+        rv = -1;
+        break;
+      }
+      my.write_window = n;
+      continue;
+    }
+
     if(str_eq(extended_param, "help")) {
       help = true;
       rv = LIBAVRDUDE_EXIT;
@@ -1909,6 +1935,12 @@ static int stk500v2_parseextparms(const PROGRAMMER *pgm, const LISTID extparms)
       msg_error("  -x fosc=off       Switch the oscillator clock off\n");
     }
     msg_error("  -x xtal=<n>[unit] Set programmer xtal frequency to <n> Hz (or kHz/MHz)\n");
+    if(pgm->paged_load_async)
+      msg_error("  -x readwindow=<n> Keep up to <n> paged read commands in flight (1..%d)\n",
+        STK500V2_MAX_WINDOW);
+    if(pgm->paged_write_async)
+      msg_error("  -x writewindow=<n> Keep up to <n> pages in flight when writing (1..%d)\n",
+        STK500V2_MAX_WINDOW/2);
     msg_error("  -x help           Show this help menu and exit\n");
     return rv;
   }
@@ -2691,26 +2723,19 @@ static int stk500isp_write_byte(const PROGRAMMER *pgm, const AVRPART *p, const A
   return 0;
 }
 
-static int stk500v2_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
-  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
-  unsigned int block_size, last_addr, addrshift, use_ext_addr;
-  unsigned int maxaddr = addr + n_bytes;
-  unsigned char commandbuf[10];
-  unsigned char buf[266];
+// Set up the 10-byte header of CMD_PROGRAM_FLASH_ISP/CMD_PROGRAM_EEPROM_ISP for memory m
+static int stk500v2_program_cmdbuf(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned char *commandbuf, unsigned int *addrshift, unsigned int *use_ext_addr) {
+
   unsigned char cmds[4];
-  int result;
   OPCODE *rop, *wop;
 
-  DEBUG("STK500V2: stk500v2_paged_write(..,%s,%u,%u,%u)\n", m->desc, page_size, addr, n_bytes);
-
-  if(page_size == 0)
-    page_size = 256;
-  addrshift = 0;
-  use_ext_addr = 0;
+  *addrshift = 0;
+  *use_ext_addr = 0;
 
   // Determine which command is to be used
   if(mem_is_flash(m)) {
-    addrshift = 1;
+    *addrshift = 1;
     my.flash_pageaddr = ~0UL; // Invalidate cache
     commandbuf[0] = CMD_PROGRAM_FLASH_ISP;
     /*
@@ -2719,7 +2744,7 @@ static int stk500v2_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const A
      * indication to STK500 that a load extended address must be executed.
      */
     if(m->op[AVR_OP_LOAD_EXT_ADDR] != NULL) {
-      use_ext_addr = (1U << 31);
+      *use_ext_addr = (1U << 31);
     }
   } else if(mem_is_eeprom(m)) {
     my.eeprom_pageaddr = ~0UL; // Invalidate cache
@@ -2727,7 +2752,7 @@ static int stk500v2_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const A
   }
   commandbuf[4] = m->delay;
 
-  if(addrshift == 0) {
+  if(*addrshift == 0) {
     wop = m->op[AVR_OP_WRITE];
     rop = m->op[AVR_OP_READ];
   } else {
@@ -2782,6 +2807,24 @@ static int stk500v2_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const A
   commandbuf[8] = m->readback[0];
   commandbuf[9] = m->readback[1];
 
+  return 0;
+}
+
+static int stk500v2_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+  unsigned int block_size, last_addr, addrshift, use_ext_addr;
+  unsigned int maxaddr = addr + n_bytes;
+  unsigned char commandbuf[10];
+  unsigned char buf[266];
+  int result;
+
+  DEBUG("STK500V2: stk500v2_paged_write(..,%s,%u,%u,%u)\n", m->desc, page_size, addr, n_bytes);
+
+  if(page_size == 0)
+    page_size = 256;
+  if(stk500v2_program_cmdbuf(pgm, p, m, commandbuf, &addrshift, &use_ext_addr) < 0)
+    return -1;
+
   last_addr = UINT_MAX;         // Impossible address
 
   for(; addr < maxaddr; addr += page_size) {
@@ -3005,6 +3048,232 @@ static int stk500v2_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AV
   return n_bytes;
 }
 
+// Forget about queued paged requests after an error
+static void stk500v2_rq_flush(const PROGRAMMER *pgm) {
+  // Advance sequence number past all answers that might still arrive
+  my.command_sequence += my.rq_n + 1;
+  my.rq_n = my.rq_head = 0;
+  (void) stk500v2_drain(pgm, 0);
+}
+
+static int stk500v2_rq_send(const PROGRAMMER *pgm, unsigned char *buf, size_t len,
+  unsigned int addr, unsigned int n) {
+
+  int i = (my.rq_head + my.rq_n)%STK500V2_MAX_WINDOW;
+
+  if(stk500v2_send(pgm, buf, len) < 0) {
+    stk500v2_rq_flush(pgm);
+    return -1;
+  }
+  my.rq[i].cmd = buf[0];
+  my.rq[i].addr = addr;
+  my.rq[i].len = n;
+  my.rq_n++;
+
+  return 0;
+}
+
+/*
+ * Send the commands for reading [addr, addr + n_bytes) without waiting for
+ * the answers, which are picked up by stk500v2_paged_load_collect(). Only
+ * STK500v2 programmers with their own serial framing can do this. The device
+ * auto-increments the address after each read, so a load address command is
+ * only queued when the reads are not contiguous or cross a 64 kB boundary.
+ *
+ * Returns LIBAVRDUDE_NOTSUPPORTED unless -x readwindow=<n> was given with
+ * n > 1 and LIBAVRDUDE_SOFTFAIL if there is no room for the commands yet.
+ */
+static int stk500v2_paged_load_async(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  unsigned int a, block_size, nextaddr, addrshift = 0, use_ext_addr = 0;
+  unsigned int maxaddr = addr + n_bytes;
+  unsigned char cmd, buf[5], cmds[4];
+  OPCODE *rop = m->op[AVR_OP_READ];
+  int ncmds;
+
+  DEBUG("STK500V2: stk500v2_paged_load_async(..,%s,%u,%u,%u)\n", m->desc, page_size, addr, n_bytes);
+
+  if(my.read_window < 2 || (my.pgmtype != PGMTYPE_STK500 && my.pgmtype != PGMTYPE_AVRISP))
+    return LIBAVRDUDE_NOTSUPPORTED;
+
+  if(mem_is_flash(m)) {
+    cmd = CMD_READ_FLASH_ISP;
+    rop = m->op[AVR_OP_READ_LO];
+    addrshift = 1;
+    if(m->op[AVR_OP_LOAD_EXT_ADDR] != NULL)
+      use_ext_addr = (1U << 31);
+  } else if(mem_is_eeprom(m)) {
+    cmd = CMD_READ_EEPROM_ISP;
+  } else
+    return LIBAVRDUDE_NOTSUPPORTED;
+
+  page_size = m->readsize;
+  if(rop == NULL || page_size < 1 || page_size > 275 - 3)
+    return LIBAVRDUDE_NOTSUPPORTED;
+
+  // Count the commands needed
+  nextaddr = my.rq_n? my.rq_nextaddr: UINT_MAX;
+  for(ncmds = 0, a = addr; a < maxaddr; a += block_size) {
+    block_size = maxaddr - a < page_size? maxaddr - a: page_size;
+    ncmds += a != nextaddr || !(a & 0xFFFF)? 2: 1;
+    nextaddr = a + block_size;
+  }
+  if(ncmds > STK500V2_MAX_WINDOW)
+    return LIBAVRDUDE_NOTSUPPORTED;
+  if(my.rq_n && my.rq_n + ncmds > my.read_window)
+    return LIBAVRDUDE_SOFTFAIL;
+
+  memset(cmds, 0, sizeof cmds);
+  avr_set_bits(rop, cmds);
+
+  nextaddr = my.rq_n? my.rq_nextaddr: UINT_MAX;
+  for(a = addr; a < maxaddr; a += block_size) {
+    block_size = maxaddr - a < page_size? maxaddr - a: page_size;
+    if(a != nextaddr || !(a & 0xFFFF)) {
+      unsigned int la = use_ext_addr | (a >> addrshift);
+
+      buf[0] = CMD_LOAD_ADDRESS;
+      buf[1] = (la >> 24) & 0xff;
+      buf[2] = (la >> 16) & 0xff;
+      buf[3] = (la >> 8) & 0xff;
+      buf[4] = la & 0xff;
+      if(stk500v2_rq_send(pgm, buf, 5, a, 0) < 0)
+        return -1;
+    }
+    buf[0] = cmd;
+    buf[1] = block_size >> 8;
+    buf[2] = block_size & 0xff;
+    buf[3] = cmds[0];
+    if(stk500v2_rq_send(pgm, buf, 4, a, block_size) < 0)
+      return -1;
+    nextaddr = a + block_size;
+  }
+  my.rq_nextaddr = nextaddr;
+
+  return 0;
+}
+
+// Retire the queued commands up to and including the last one for an address below end
+static int stk500v2_rq_collect(const PROGRAMMER *pgm, const AVRMEM *m, unsigned int end) {
+  unsigned char buf[275];
+
+  while(my.rq_n) {
+    int status, i = my.rq_head;
+    unsigned char cmd = my.rq[i].cmd;
+    unsigned int len = my.rq[i].len;
+
+    if(cmd != CMD_LOAD_ADDRESS && my.rq[i].addr >= end)
+      break;                    // Belongs to a later page
+
+    // Answers are cmd, status[, data, status2]
+    status = stk500v2_recv(pgm, buf, sizeof buf);
+    if(status < 6 + 2 || buf[0] != cmd || buf[1] != STATUS_CMD_OK ||
+      (len && (unsigned int) status < 6 + 3 + len)) {
+
+      pmsg_error("pipelined %s command 0x%02x failed (%d)\n", m->desc, cmd, status);
+      stk500v2_rq_flush(pgm);
+      return -1;
+    }
+    if(len)
+      memcpy(m->buf + my.rq[i].addr, buf + 2, len);
+
+    my.rq_head = (i + 1)%STK500V2_MAX_WINDOW;
+    my.rq_n--;
+  }
+
+  return 0;
+}
+
+static int stk500v2_paged_load_collect(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  DEBUG("STK500V2: stk500v2_paged_load_collect(..,%s,%u,%u,%u)\n", m->desc, page_size, addr, n_bytes);
+
+  return stk500v2_rq_collect(pgm, m, addr + n_bytes) < 0? -1: (int) n_bytes;
+}
+
+/*
+ * Queue the load address and program commands for [addr, addr + n_bytes)
+ * without waiting for the programming to finish, so the next page travels
+ * down the serial line while the device is still busy with this one. Only
+ * sensible with -x writewindow=<n> for programmers whose firmware receives
+ * the next command while a page is being programmed.
+ *
+ * Returns LIBAVRDUDE_NOTSUPPORTED if not applicable and LIBAVRDUDE_SOFTFAIL
+ * if there is no room for the commands yet.
+ */
+static int stk500v2_paged_write_async(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  unsigned int a, block_size, addrshift, use_ext_addr, maxaddr = addr + n_bytes;
+  unsigned char buf[266];
+  int ncmds;
+
+  DEBUG("STK500V2: stk500v2_paged_write_async(..,%s,%u,%u,%u)\n", m->desc, page_size, addr, n_bytes);
+
+  if(my.write_window < 2 || (my.pgmtype != PGMTYPE_STK500 && my.pgmtype != PGMTYPE_AVRISP))
+    return LIBAVRDUDE_NOTSUPPORTED;
+  if(!mem_is_flash(m) && !mem_is_eeprom(m))
+    return LIBAVRDUDE_NOTSUPPORTED;
+
+  if(page_size == 0)
+    page_size = 256;
+  if(page_size > sizeof buf - 10)
+    return LIBAVRDUDE_NOTSUPPORTED;
+
+  // Each page needs a load address and a program command; the window counts pages
+  ncmds = 2*((n_bytes + page_size - 1)/page_size);
+  if(ncmds > STK500V2_MAX_WINDOW)
+    return LIBAVRDUDE_NOTSUPPORTED;
+  if(my.rq_n && my.rq_n + ncmds > 2*my.write_window)
+    return LIBAVRDUDE_SOFTFAIL;
+
+  if(stk500v2_program_cmdbuf(pgm, p, m, buf, &addrshift, &use_ext_addr) < 0)
+    return -1;
+
+  for(a = addr; a < maxaddr; a += block_size) {
+    unsigned int la = use_ext_addr | (a >> addrshift);
+    unsigned char *d = m->buf + a, lbuf[5];
+
+    block_size = maxaddr - a < page_size? maxaddr - a: page_size;
+
+    // Do not send request to write empty flash pages except for bootloaders (Issue #425)
+    if(!is_spm(pgm) && addrshift && *d == 0xff && !memcmp(d, d + 1, block_size - 1))
+      continue;
+
+    lbuf[0] = CMD_LOAD_ADDRESS;
+    lbuf[1] = (la >> 24) & 0xff;
+    lbuf[2] = (la >> 16) & 0xff;
+    lbuf[3] = (la >> 8) & 0xff;
+    lbuf[4] = la & 0xff;
+    if(stk500v2_rq_send(pgm, lbuf, 5, a, 0) < 0)
+      return -1;
+
+    buf[1] = block_size >> 8;
+    buf[2] = block_size & 0xff;
+    memcpy(buf + 10, d, block_size);
+    if(stk500v2_rq_send(pgm, buf, block_size + 10, a, 0) < 0)
+      return -1;
+  }
+  my.rq_nextaddr = UINT_MAX;    // Force a load address for the next pipelined read
+
+  return 0;
+}
+
+static int stk500v2_paged_write_collect(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  DEBUG("STK500V2: stk500v2_paged_write_collect(..,%s,%u,%u,%u)\n", m->desc, page_size, addr, n_bytes);
+
+  if(stk500v2_rq_collect(pgm, m, addr + n_bytes) < 0) {
+    pmsg_error("write command failed\n");
+    return -1;
+  }
+
+  return n_bytes;
+}
+
 // Read pages of flash/EEPROM, generic HV mode
 static int stk500hv_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
   unsigned int page_size, unsigned int addr, unsigned int n_bytes, enum hvmode mode) {
@@ -4755,6 +5024,10 @@ void stk500v2_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = stk500v2_paged_write;
   pgm->paged_load = stk500v2_paged_load;
+  pgm->paged_load_async = stk500v2_paged_load_async;
+  pgm->paged_load_collect = stk500v2_paged_load_collect;
+  pgm->paged_write_async = stk500v2_paged_write_async;
+  pgm->paged_write_collect = stk500v2_paged_write_collect;
   pgm->page_erase = NULL;
   pgm->print_parms = stk500v2_print_parms;
   pgm->set_sck_period = stk500v2_set_sck_period;
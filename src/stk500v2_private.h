@@ -234,6 +234,9 @@
 
 #define ANSWER_CKSUM_ERROR                  0xB0
 
+// Max number of commands in flight for pipelined paged reads (-x readwindow)
+#define STK500V2_MAX_WINDOW                 32
+
 struct pdata {
   // See stk500pp_read_byte() for an explanation of the flash and EEPROM page caches
   unsigned char *flash_pagecache;
@@ -246,6 +249,16 @@ struct pdata {
 
   unsigned char command_sequence;
 
+  // Pipelined paged reads and writes, see stk500v2_paged_load_async()
+  int read_window;              // Max number of read commands in flight, set by -x readwindow=<n>
+  int write_window;             // Max number of pages in flight, set by -x writewindow=<n>
+  int rq_n, rq_head;            // Number of queued commands and index of oldest in rq[]
+  unsigned int rq_nextaddr;     // Device address following the last queued read
+  struct {
+    unsigned char cmd;          // CMD_LOAD_ADDRESS, CMD_READ_*_ISP or CMD_PROGRAM_*_ISP
+    unsigned int addr, len;     // Memory address and length of read (0 for other commands)
+  } rq[STK500V2_MAX_WINDOW];
+
   enum {
     PGMTYPE_UNKNOWN,
     PGMTYPE_STK500,
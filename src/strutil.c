@@ -645,6 +645,23 @@ int is_memset(const void *p, char c, size_t n) {
   return n <= 0 || (*q == c && memcmp(q, q + 1, n - 1) == 0);
 }
 
+/*
+ * Like memset() but only write 4 KiB blocks that do not already hold c:
+ * untouched pages of a large, freshly allocated (zeroed) buffer are then not
+ * mapped into resident memory when clearing it
+ */
+void *memset_sparse(void *p, int c, size_t n) {
+  char *q = (char *) p;
+
+  for(size_t i = 0, len; i < n; i += len) {
+    len = n - i < 4096? n - i: 4096;
+    if(!is_memset(q + i, c, len))
+      memset(q + i, c, len);
+  }
+
+  return p;
+}
+
 // https://en.wikipedia.org/wiki/Easter_egg_(media)#Software
 unsigned long long int easteregg(const char *str, const char **endpp) {
   unsigned long long int ret = 0;
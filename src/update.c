@@ -59,16 +59,16 @@ UPDATE *parse_op(const char *s) {
   const char *fc = strchr(s, ':');
 
   if(fc && fc[1] && fc[2] == ':') {
-    if(!strchr("rwv", fc[1])) {
+    if(!strchr("rwvd", fc[1])) {
       pmsg_error("invalid I/O mode :%c: in -U %s\n", fc[1], s);
-      imsg_error("I/O mode can be r, w or v for read, write or verify device\n");
+      imsg_error("I/O mode can be r, w, v or d for read, write, verify or delta write device\n");
       mmt_free(upd->memstr);
       mmt_free(upd);
       return NULL;
     }
 
     upd->memstr = memcpy(mmt_malloc(fc - s + 1), s, fc - s);
-    upd->op = fc[1] == 'r'? DEVICE_READ: fc[1] == 'w'? DEVICE_WRITE: DEVICE_VERIFY;
+    upd->op = fc[1] == 'r'? DEVICE_READ: fc[1] == 'w'? DEVICE_WRITE: fc[1] == 'v'? DEVICE_VERIFY: DEVICE_DELTA;
     fn = fc + 3;
   }
   // Autodetect for file reads, and hex (multi-mem)/raw (single mem) for file writes
@@ -134,7 +134,7 @@ char *update_str(const UPDATE *upd) {
   if(upd->cmdline)
     return mmt_sprintf("-%c %s", str_eq("interactive terminal", upd->cmdline)? 't': 'T', upd->cmdline);
   return mmt_sprintf("-U %s:%c:%s:%c", upd->memstr,
-    upd->op == DEVICE_READ? 'r': upd->op == DEVICE_WRITE? 'w': 'v',
+    upd->op == DEVICE_READ? 'r': upd->op == DEVICE_WRITE? 'w': upd->op == DEVICE_VERIFY? 'v': 'd',
     upd->filename, fileio_fmtchr(upd->format));
 }
 
@@ -173,7 +173,13 @@ int memstats_mem(const AVRPART *p, const AVRMEM *mem, int size, Filestats *fsp)
 
   // Scan all memory
   for(int addr = 0; addr < mem->size;) {
-    int pageset = 0;
+    int pageset = 0, end = addr + pgsize < mem->size? addr + pgsize: mem->size;
+
+    if(avr_mem_next_allocated(mem, addr, end) >= end) { // Skip empty page quickly
+      insection = 0;
+      addr = end;
+      continue;
+    }
 
     // Go page by page
     for(int pgi = 0; pgi < pgsize; pgi++, addr++) {
@@ -390,7 +396,7 @@ int update_dryrun(const AVRPART *p, UPDATE *upd) {
 
   known = 0;
   // Necessary to check whether the file is readable?
-  if(upd->op == DEVICE_VERIFY || upd->op == DEVICE_WRITE || upd->format == FMT_AUTO) {
+  if(upd->op != DEVICE_READ || upd->format == FMT_AUTO) {
     if(upd->format != FMT_IMM) {
       // Need to read the file: was it written before, so will be known?
       for(int i = 0; i < cx->upd_nfwritten; i++)
@@ -450,6 +456,7 @@ int update_dryrun(const AVRPART *p, UPDATE *upd) {
 
   case DEVICE_VERIFY:          // Already checked that file is readable
   case DEVICE_WRITE:
+  case DEVICE_DELTA:
     break;
 
   default:
@@ -460,6 +467,49 @@ int update_dryrun(const AVRPART *p, UPDATE *upd) {
   return ret;
 }
 
+/*
+ * Decode the input file of a -U write, delta or verify ahead of time so that
+ * fileio_mem() finds the image in its cache, eg, in the forked processes of
+ * gang programming. Nothing is decoded for stdin, immediate data or files
+ * that do not exist yet; the real -U operation deals with those later.
+ */
+int update_decode_input(const AVRPART *p, const UPDATE *upd) {
+  if(upd->cmdline || upd->op == DEVICE_READ || upd->format == FMT_IMM || !upd->memstr ||
+    !upd->filename || str_eq(upd->filename, "-") || !update_is_readable(upd->filename))
+    return 0;
+
+  int format = upd->format == FMT_AUTO? fileio_fmt_autodetect(upd->filename): (int) upd->format;
+  AVRMEM *mem = NULL;
+
+  if(format < 0)
+    return -1;
+  if(is_multimem(upd->memstr))
+    mem = fileio_any_memory("any");
+  else if((mem = avr_locate_mem(p, upd->memstr))) {     // Decode into a copy, not the part's buffer
+    mem = avr_dup_mem(mem);
+    if(!mem->buf)
+      mem->buf = mmt_malloc(mem->size);
+    if(!mem->tags)
+      mem->tags = mmt_malloc(mem->size);
+  }
+  if(!mem)
+    return -1;
+
+  int op = upd->op == DEVICE_WRITE? FIO_READ: FIO_READ_FOR_VERIFY;
+  int rc = fileio_mem(op, upd->filename, format, p, mem, -1);
+
+  avr_free_mem(mem);
+
+  return rc < 0? -1: 0;
+}
+
+// Will -U mem:d:... only write and verify pages that differ from the device?
+static int update_is_delta(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
+  const UPDATE *upd, enum updateflags flags) {
+
+  return upd->op == DEVICE_DELTA && !(flags & UF_NOWRITE) && avr_has_paged_access(pgm, p, mem);
+}
+
 static int update_avr_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
   const UPDATE *upd, enum updateflags flags, int size, int multiple) {
 
@@ -517,10 +567,31 @@ static int update_avr_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRME
   if(flags & UF_NOWRITE) {
     // Test mode: write to stdout in intel hex rather than to the chip
     rc = fileio_mem(FIO_WRITE, "-", FMT_IHEX, p, mem, size);
+  } else if(update_is_delta(pgm, p, mem, upd, flags)) {
+    int npages = 0;
+
+    if(pbar)
+      report_progress(0, 1, str_ccprintf("%*sComparing", (int) strlen(progbuf), ""));
+    stats_begin("delta", mem->desc);
+    rc = avr_write_mem_delta(pgm, p, mem, size, &npages);
+    stats_end();
+    if(rc < 0)
+      return -1;
+    // Changed pages were verified by reading them back, unchanged ones by comparison
+    const char *res = str_ccprintf("%d of %d page%s of %s written and verified",
+      rc, npages, str_plural(npages), m_name);
+
+    if(pbar)
+      pmsg_info("%s\n", res);
+    else
+      msg_info(", %s\n", res);
+    return size;
   } else {
     if(pbar)
       report_progress(0, 1, str_ccprintf("%*sWriting", (int) strlen(progbuf), ""));
+    stats_begin("write", mem->desc);
     rc = avr_write_mem(pgm, p, mem, size, (flags & UF_AUTO_ERASE) != 0);
+    stats_end();
     report_progress(1, 1, NULL);
   }
 
@@ -549,8 +620,10 @@ static int update_avr_verify(const PROGRAMMER *pgm, const AVRPART *p, const AVRM
   led_set(pgm, LED_VFY);
   if(pbar)
     report_progress(0, 1, caption);
+  stats_begin("verify", mem->desc);
   int rc = avr_read_mem(pgm, p, mem, v);
 
+  stats_end();
   report_progress(1, 1, NULL);
   if(rc < 0) {
     pmsg_error("unable to read all of %s (rc = %d)\n", m_name, rc);
@@ -608,6 +681,7 @@ static int update_mem_from_all(const UPDATE *upd, const AVRPART *p, const AVRMEM
 static int update_all_from_file(const UPDATE *upd, const PROGRAMMER *pgm, const AVRPART *p,
   const AVRMEM *all, const char *mem_desc, Filestats *fsp) {
   // On writing to the device trailing 0xff might be cut off
+  // Delta writes compare all bytes: trailing 0xff on device may need writing without a chip erase
   int op = upd->op == DEVICE_WRITE? FIO_READ: FIO_READ_FOR_VERIFY;
   int allsize = fileio_mem(op, upd->filename, upd->format, p, all, -1);
 
@@ -617,7 +691,7 @@ static int update_all_from_file(const UPDATE *upd, const PROGRAMMER *pgm, const
   }
   if(memstats_mem(p, all, allsize, fsp) < 0)
     return -1;
-  pmsg_info(upd->op == DEVICE_WRITE?
+  pmsg_info(upd->op == DEVICE_WRITE || upd->op == DEVICE_DELTA?
     "reading %d byte%s for %s from input file %s\n":
     "verifying %d byte%s of %s against input file %s\n",
     fsp->nbytes, str_plural(fsp->nbytes), mem_desc, str_infilename(upd->filename)
@@ -714,8 +788,10 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
         const char *cap = str_ccprintf("%*s - %-*s", (int) strlen(progbuf), "", maxrlen, m_name);
 
         report_progress(0, 1, cap);
+        stats_begin("read", m->desc);
         int ret = avr_read_mem(pgm, p, m, NULL);
 
+        stats_end();
         report_progress(1, 1, NULL);
         if(ret < 0) {
           pmsg_warning("unable to read %s (ret = %d), skipping...\n", m_name, ret);
@@ -749,7 +825,9 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
       pmsg_info("reading %s memory ...\n", mem_desc);
       if(mem->size > 32)
         report_progress(0, 1, rcap);
+      stats_begin("read", mem->desc);
       rc = avr_read(pgm, p, umstr, 0);
+      stats_end();
       report_progress(1, 1, NULL);
       if(rc < 0) {
         pmsg_error("unable to read all of %s (rc = %d)\n", mem_desc, rc);
@@ -768,6 +846,7 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
     break;
 
   case DEVICE_WRITE:
+  case DEVICE_DELTA:
     // Write the selected device memory/ies using data from a file
     if((allsize = update_all_from_file(upd, pgm, p, mem, mem_desc, &fs)) < 0)
       goto error;
@@ -794,7 +873,8 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
             continue;
           }
           // @@@ verify size could be too small if file was not a multi-file and had trailing 0xff
-          if((flags & UF_VERIFY) && update_avr_verify(pgm, p, m, upd, size, rcap) < 0) {
+          if((flags & UF_VERIFY) && !update_is_delta(pgm, p, m, upd, flags) &&
+            update_avr_verify(pgm, p, m, upd, size, rcap) < 0) {
             rwvproblem = 1;
             continue;
           }
@@ -805,7 +885,8 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
         pmsg_error("unable to write %s (rc = %d)\n", mem_desc, rc);
         goto error;
       }
-      if((flags & UF_VERIFY) && update_avr_verify(pgm, p, mem, upd, fs.lastaddr + 1, rcap) < 0)
+      if((flags & UF_VERIFY) && !update_is_delta(pgm, p, mem, upd, flags) &&
+        update_avr_verify(pgm, p, mem, upd, fs.lastaddr + 1, rcap) < 0)
         goto error;
     }
     break;
@@ -73,11 +73,49 @@ static int updi_physical_open(PROGRAMMER *pgm, int baudrate, unsigned long cflag
 }
 
 static void updi_physical_close(PROGRAMMER *pgm) {
+  updi_set_echo_len(pgm, 0);
   serial_set_dtr_rts(&pgm->fd, 0);
   serial_close(&pgm->fd);
   pgm->fd.ifd = -1;
 }
 
+/*
+ * The single-wire UPDI interface echoes every byte sent. Rather than waiting
+ * for the echo after each frame, updi_physical_send() remembers the bytes sent
+ * and their echo is read together with the next response, so that frames can
+ * be sent back to back.
+ *
+ * Read pending echo followed by len response bytes; check the echo unless
+ * check is 0
+ */
+static int updi_physical_recv_echo(const PROGRAMMER *pgm, unsigned char *buf, size_t len, int check) {
+  size_t n = updi_get_echo_len(pgm);
+  unsigned char spc[UPDI_ECHO_MAX + 512], *tmp;
+  int rv;
+
+  if(n == 0)
+    return serial_recv(&pgm->fd, buf, len);
+
+  tmp = n + len > sizeof spc? mmt_malloc(n + len): spc;
+  updi_set_echo_len(pgm, 0);
+  rv = serial_recv(&pgm->fd, tmp, n + len);
+  if(rv >= 0 && check && memcmp(tmp, updi_get_echo(pgm), n)) {
+    pmsg_debug("%s(): echo of %lu bytes sent does not match\n", __func__, (unsigned long) n);
+    rv = -1;
+  }
+  if(rv >= 0 && len)
+    memcpy(buf, tmp + n, len);
+  if(tmp != spc)
+    mmt_free(tmp);
+
+  return rv;
+}
+
+// Read and discard pending echo
+static int updi_physical_flush_echo(const PROGRAMMER *pgm, int check) {
+  return updi_physical_recv_echo(pgm, NULL, 0, check);
+}
+
 static int updi_physical_send(const PROGRAMMER *pgm, unsigned char *buf, size_t len) {
   size_t i;
   int rv;
@@ -91,8 +129,21 @@ static int updi_physical_send(const PROGRAMMER *pgm, unsigned char *buf, size_t
   }
   msg_debug("]\n");
 
+  if(updi_get_echo_len(pgm) + len > UPDI_ECHO_MAX)
+    if(updi_physical_flush_echo(pgm, 1) < 0)
+      return -1;
+
   rv = serial_send(&pgm->fd, buf, len);
-  serial_recv(&pgm->fd, buf, len);
+  if(rv < 0)
+    return rv;
+
+  if(len > UPDI_ECHO_MAX) {     // Too long to defer: swallow echo now
+    serial_recv(&pgm->fd, buf, len);
+  } else {
+    memcpy(updi_get_echo(pgm) + updi_get_echo_len(pgm), buf, len);
+    updi_set_echo_len(pgm, updi_get_echo_len(pgm) + len);
+  }
+
   return rv;
 }
 
@@ -100,7 +151,7 @@ static int updi_physical_recv(const PROGRAMMER *pgm, unsigned char *buf, size_t
   size_t i;
   int rv;
 
-  rv = serial_recv(&pgm->fd, buf, len);
+  rv = updi_physical_recv_echo(pgm, buf, len, 1);
   if(rv < 0) {
     pmsg_debug("%s(): programmer is not responding\n", __func__);
     return -1;
@@ -123,6 +174,7 @@ static int updi_physical_send_double_break(const PROGRAMMER *pgm) {
 
   pmsg_debug("sending double break\n");
 
+  updi_physical_flush_echo(pgm, 0);     // Link is in disarray anyway
   if(serial_setparams(&pgm->fd, 300, SERIAL_8E1) < 0) {
     return -1;
   }
@@ -187,7 +239,12 @@ int updi_link_open(PROGRAMMER *pgm) {
   }
 
   init_buffer[0] = UPDI_BREAK;
-  return updi_physical_send(pgm, init_buffer, 1);
+  if(updi_physical_send(pgm, init_buffer, 1) < 0)
+    return -1;
+
+  updi_physical_flush_echo(pgm, 0);     // Break echo need not read as sent nor arrive at all
+
+  return 0;
 }
 
 void updi_link_close(PROGRAMMER *pgm) {
@@ -509,7 +566,7 @@ int updi_link_st_ptr_inc16(const PROGRAMMER *pgm, unsigned char *buffer, uint16_
     return -1;
   }
 
-  while(num < words) {
+  while(num < words*2) {
     send_buffer[0] = buffer[num];
     send_buffer[1] = buffer[num + 1];
     if(updi_physical_send(pgm, send_buffer, 2) < 0) {
@@ -528,56 +585,20 @@ int updi_link_st_ptr_inc16(const PROGRAMMER *pgm, unsigned char *buffer, uint16_
   return 0;
 }
 
-int updi_link_st_ptr_inc16_RSD(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t words, int blocksize) {
 /*
-    def st_ptr_inc16_RSD(self, data, blocksize):
-        """
-        Store a 16-bit word value to the pointer location with pointer post-increment
-        :param data: data to store
-        :blocksize: max number of bytes being sent -1 for all.
-                    Warning: This does not strictly honor blocksize for values < 6
-                    We always glob together the STCS(RSD) and REP commands.
-                    But this should pose no problems for compatibility, because your serial adapter can't deal with 6b chunks,
-                    none of pymcuprog would work!
-        """
-        self.logger.debug("ST16 to *ptr++ with RSD, data length: 0x%03X in blocks of:  %d", len(data), blocksize)
-
-        #for performance we glob everything together into one USB transfer ...
-        repnumber= ((len(data) >> 1) -1)
-        data = [*data, *[constants.UPDI_PHY_SYNC, constants.UPDI_STCS | constants.UPDI_CS_CTRLA, 0x06]]
-
-        if blocksize == -1:
-            # Send whole thing at once stcs + repeat + st + (data + stcs)
-            blocksize = 3 + 3 + 2 + len(data)
-        num = 0
-        firstpacket = []
-        if blocksize < 10:
-            # very small block size - we send pair of 2-byte commands first.
-            firstpacket = [*[constants.UPDI_PHY_SYNC, constants.UPDI_STCS | constants.UPDI_CS_CTRLA, 0x0E],
-                            *[constants.UPDI_PHY_SYNC, constants.UPDI_REPEAT | constants.UPDI_REPEAT_BYTE, (repnumber & 0xFF)]]
-            data = [*[constants.UPDI_PHY_SYNC, constants.UPDI_ST | constants.UPDI_PTR_INC |constants.UPDI_DATA_16], *data]
-            num = 0
-        else:
-            firstpacket = [*[constants.UPDI_PHY_SYNC, constants.UPDI_STCS | constants.UPDI_CS_CTRLA , 0x0E],
-                            *[constants.UPDI_PHY_SYNC, constants.UPDI_REPEAT | constants.UPDI_REPEAT_BYTE, (repnumber & 0xFF)],
-                            *[constants.UPDI_PHY_SYNC, constants.UPDI_ST | constants.UPDI_PTR_INC | constants.UPDI_DATA_16],
-                            *data[:blocksize - 8]]
-            num = blocksize - 8
-        self.updi_phy.send(firstpacket)
-
-        # if finite block size, this is used.
-        while num < len(data):
-            data_slice = data[num:num+blocksize]
-            self.updi_phy.send(data_slice)
-            num += len(data_slice)
-*/
-  pmsg_debug("ST16 to *ptr++ with RSD, data length: 0x%03X in blocks of: %d\n", words*2, blocksize);
+ * Store n bytes or words (datasize UPDI_DATA_8 or UPDI_DATA_16) to *ptr++ in
+ * one burst: switch on response signature disable, repeat the store n times,
+ * switch RSD off again and send all that in serial writes of at most
+ * blocksize bytes (no limit if blocksize <= 0); n must not exceed 256
+ */
+static int updi_link_st_ptr_inc_burst(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t n,
+  int datasize, int blocksize) {
 
-  unsigned int temp_buffer_size = 3 + 3 + 2 + (words*2) + 3;
+  unsigned int len = n << datasize, temp_buffer_size = 3 + 3 + 2 + len + 3;
   unsigned int num = 0;
   unsigned char *temp_buffer = mmt_malloc(temp_buffer_size);
 
-  if(blocksize == -1) {
+  if(blocksize <= 0) {
     blocksize = temp_buffer_size;
   }
 
@@ -586,17 +607,17 @@ int updi_link_st_ptr_inc16_RSD(const PROGRAMMER *pgm, unsigned char *buffer, uin
   temp_buffer[2] = 0x0E;
   temp_buffer[3] = UPDI_PHY_SYNC;
   temp_buffer[4] = UPDI_REPEAT | UPDI_REPEAT_BYTE;
-  temp_buffer[5] = (words - 1) & 0xFF;
+  temp_buffer[5] = (n - 1) & 0xFF;
   temp_buffer[6] = UPDI_PHY_SYNC;
-  temp_buffer[7] = UPDI_ST | UPDI_PTR_INC | UPDI_DATA_16;
+  temp_buffer[7] = UPDI_ST | UPDI_PTR_INC | datasize;
 
-  memcpy(temp_buffer + 8, buffer, words*2);
+  memcpy(temp_buffer + 8, buffer, len);
 
   temp_buffer[temp_buffer_size - 3] = UPDI_PHY_SYNC;
   temp_buffer[temp_buffer_size - 2] = UPDI_STCS | UPDI_CS_CTRLA;
   temp_buffer[temp_buffer_size - 1] = 0x06;
 
-  if(blocksize < 10) {
+  if(blocksize < 10) {          // Very small block size: send RSD and repeat commands first
     if(updi_physical_send(pgm, temp_buffer, 6) < 0) {
       pmsg_debug("unable to send first package\n");
       mmt_free(temp_buffer);
@@ -626,6 +647,60 @@ int updi_link_st_ptr_inc16_RSD(const PROGRAMMER *pgm, unsigned char *buffer, uin
   return 0;
 }
 
+int updi_link_st_ptr_inc16_RSD(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t words, int blocksize) {
+/*
+    def st_ptr_inc16_RSD(self, data, blocksize):
+        """
+        Store a 16-bit word value to the pointer location with pointer post-increment
+        :param data: data to store
+        :blocksize: max number of bytes being sent -1 for all.
+                    Warning: This does not strictly honor blocksize for values < 6
+                    We always glob together the STCS(RSD) and REP commands.
+                    But this should pose no problems for compatibility, because your serial adapter can't deal with 6b chunks,
+                    none of pymcuprog would work!
+        """
+        self.logger.debug("ST16 to *ptr++ with RSD, data length: 0x%03X in blocks of:  %d", len(data), blocksize)
+
+        #for performance we glob everything together into one USB transfer ...
+        repnumber= ((len(data) >> 1) -1)
+        data = [*data, *[constants.UPDI_PHY_SYNC, constants.UPDI_STCS | constants.UPDI_CS_CTRLA, 0x06]]
+
+        if blocksize == -1:
+            # Send whole thing at once stcs + repeat + st + (data + stcs)
+            blocksize = 3 + 3 + 2 + len(data)
+        num = 0
+        firstpacket = []
+        if blocksize < 10:
+            # very small block size - we send pair of 2-byte commands first.
+            firstpacket = [*[constants.UPDI_PHY_SYNC, constants.UPDI_STCS | constants.UPDI_CS_CTRLA, 0x0E],
+                            *[constants.UPDI_PHY_SYNC, constants.UPDI_REPEAT | constants.UPDI_REPEAT_BYTE, (repnumber & 0xFF)]]
+            data = [*[constants.UPDI_PHY_SYNC, constants.UPDI_ST | constants.UPDI_PTR_INC |constants.UPDI_DATA_16], *data]
+            num = 0
+        else:
+            firstpacket = [*[constants.UPDI_PHY_SYNC, constants.UPDI_STCS | constants.UPDI_CS_CTRLA , 0x0E],
+                            *[constants.UPDI_PHY_SYNC, constants.UPDI_REPEAT | constants.UPDI_REPEAT_BYTE, (repnumber & 0xFF)],
+                            *[constants.UPDI_PHY_SYNC, constants.UPDI_ST | constants.UPDI_PTR_INC | constants.UPDI_DATA_16],
+                            *data[:blocksize - 8]]
+            num = blocksize - 8
+        self.updi_phy.send(firstpacket)
+
+        # if finite block size, this is used.
+        while num < len(data):
+            data_slice = data[num:num+blocksize]
+            self.updi_phy.send(data_slice)
+            num += len(data_slice)
+*/
+  pmsg_debug("ST16 to *ptr++ with RSD, data length: 0x%03X in blocks of: %d\n", words*2, blocksize);
+
+  return updi_link_st_ptr_inc_burst(pgm, buffer, words, UPDI_DATA_16, blocksize);
+}
+
+int updi_link_st_ptr_inc_RSD(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t size, int blocksize) {
+  pmsg_debug("ST8 to *ptr++ with RSD, data length: 0x%03X in blocks of: %d\n", size, blocksize);
+
+  return updi_link_st_ptr_inc_burst(pgm, buffer, size, UPDI_DATA_8, blocksize);
+}
+
 int updi_link_repeat(const PROGRAMMER *pgm, uint16_t repeats) {
 /*
     def repeat(self, repeats):
@@ -40,6 +40,7 @@ extern "C" {
   int updi_link_ld_ptr_inc16(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t words);
   int updi_link_st_ptr_inc(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t size);
   int updi_link_st_ptr_inc16(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t words);
+  int updi_link_st_ptr_inc_RSD(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t size, int blocksize);
   int updi_link_st_ptr_inc16_RSD(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t words, int blocksize);
   int updi_link_repeat(const PROGRAMMER *pgm, uint16_t repeats);
   int updi_link_read_sib(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t size);
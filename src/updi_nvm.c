@@ -40,6 +40,7 @@
 #include "updi_nvm_v4.h"
 #include "updi_nvm_v5.h"
 #include "updi_state.h"
+#include "updi_readwrite.h"
 
 int updi_nvm_chip_erase(const PROGRAMMER *pgm, const AVRPART *p) {
   switch(updi_get_nvm_mode(pgm)) {
@@ -246,3 +247,143 @@ int updi_nvm_command(const PROGRAMMER *pgm, const AVRPART *p, uint8_t command) {
     return -1;
   }
 }
+
+/*
+ * Waiting for the NVM controller: rather than spinning on NVMCTRL.STATUS, sleep
+ * for the expected duration of the operation started last, then poll with
+ * exponential backoff. Expected durations are seeded from the write and erase
+ * delays in avrdude.conf and then learned from observed completion times.
+ */
+
+#define UPDI_NVM_TIMEOUT   10000000     // Give up after 10 s
+#define UPDI_NVM_POLL_MIN        50     // First backoff interval in us
+#define UPDI_NVM_POLL_MAX     10000     // Longest backoff interval in us
+
+static const char *updi_nvm_opname(updi_nvm_op op) {
+  switch(op) {
+  case UPDI_NVM_OP_CHIP_ERASE:
+    return "chip erase";
+  case UPDI_NVM_OP_PAGE_ERASE:
+    return "page erase";
+  case UPDI_NVM_OP_PAGE_WRITE:
+    return "page write";
+  case UPDI_NVM_OP_EEPROM_ERASE:
+    return "EEPROM erase";
+  case UPDI_NVM_OP_EEPROM_WRITE:
+    return "EEPROM write";
+  case UPDI_NVM_OP_FUSE_WRITE:
+    return "fuse write";
+  default:
+    return "ready check";
+  }
+}
+
+// Duration of operation op in us according to avrdude.conf (0 if unknown)
+static uint32_t updi_nvm_conf_time(const AVRPART *p, updi_nvm_op op) {
+  const AVRMEM *m;
+
+  switch(op) {
+  case UPDI_NVM_OP_CHIP_ERASE:
+    return p->chip_erase_delay > 0? p->chip_erase_delay: 0;
+  case UPDI_NVM_OP_PAGE_ERASE:
+  case UPDI_NVM_OP_PAGE_WRITE:
+    m = avr_locate_flash(p);
+    break;
+  case UPDI_NVM_OP_EEPROM_ERASE:
+  case UPDI_NVM_OP_EEPROM_WRITE:
+    m = avr_locate_eeprom(p);
+    break;
+  case UPDI_NVM_OP_FUSE_WRITE:
+    if(!(m = avr_locate_fuses(p)))
+      m = avr_locate_fuse0(p);
+    break;
+  default:
+    return 0;
+  }
+
+  return m && m->min_write_delay > 0? m->min_write_delay: 0;
+}
+
+// Note that an NVM command has just started operation op
+void updi_nvm_started(const PROGRAMMER *pgm, const AVRPART *p, updi_nvm_op op) {
+  updi_nvm_timing *s = updi_get_nvm_timing(pgm);
+
+  s->op = op;
+  s->t_op = avr_ustimestamp();
+  if(op != UPDI_NVM_OP_NONE && !s->waits[op])       // Not observed yet
+    s->expect[op] = updi_nvm_conf_time(p, op);
+}
+
+/*
+ * Wait until none of the busy_mask bits are set in the NVM status register at
+ * status_addr; error_mask/error_bit describe its write error field. Returns 0
+ * when ready and -1 on NVM error or after a timeout of 10 s.
+ */
+int updi_nvm_wait_status(const PROGRAMMER *pgm, const AVRPART *p, uint32_t status_addr,
+  uint8_t busy_mask, uint8_t error_mask, int error_bit) {
+
+  updi_nvm_timing *s = updi_get_nvm_timing(pgm);
+  updi_nvm_op op = s->op;
+  uint64_t start = avr_ustimestamp(), now, t_busy = 0;
+  uint32_t backoff = UPDI_NVM_POLL_MIN, slept = 0;
+  long polls = 0;
+  uint8_t status;
+
+  if(op != UPDI_NVM_OP_NONE && s->t_op + s->expect[op] > start) {
+    slept = s->t_op + s->expect[op] - start;
+    usleep(slept);
+  }
+
+  for(;;) {
+    polls++;
+    if(updi_read_byte(pgm, status_addr, &status) >= 0) {
+      if(status & error_mask) {
+        pmsg_error("unable to write NVM status, error code %d\n", (status & error_mask) >> error_bit);
+        s->op = UPDI_NVM_OP_NONE;
+        return -1;
+      }
+      if(!(status & busy_mask))
+        break;
+      t_busy = avr_ustimestamp();
+    }
+    now = avr_ustimestamp();
+    if(now - start >= UPDI_NVM_TIMEOUT) {
+      pmsg_error("wait NVM ready timed out\n");
+      s->op = UPDI_NVM_OP_NONE;
+      return -1;
+    }
+    usleep(backoff);
+    if((backoff *= 2) > UPDI_NVM_POLL_MAX)
+      backoff = UPDI_NVM_POLL_MAX;
+  }
+
+  now = avr_ustimestamp();
+  s->waits[op]++;
+  s->polls[op] += polls;
+  if(op != UPDI_NVM_OP_NONE) {
+    uint32_t *expect = s->expect + op;
+
+    if(t_busy) {                // Completed between last busy poll and now
+      uint32_t seen = (t_busy + now)/2 - s->t_op;
+
+      *expect = *expect? (*expect + seen)/2: seen;
+    } else if(slept)            // Ready on first poll: try a little less next time
+      *expect -= *expect/16;
+    pmsg_debug("%s done after %.3f ms with %ld poll%s, next expected %.3f ms\n", updi_nvm_opname(op),
+      (now - s->t_op)/1000.0, polls, str_plural(polls), *expect/1000.0);
+  }
+  s->op = UPDI_NVM_OP_NONE;
+
+  return 0;
+}
+
+// Show how often NVM status was polled per operation
+void updi_nvm_report(const PROGRAMMER *pgm) {
+  updi_nvm_timing *s = updi_get_nvm_timing(pgm);
+
+  for(int op = 0; op < UPDI_NVM_OP_N; op++)
+    if(s->waits[op])
+      pmsg_notice("NVM %s: %ld poll%s in %ld wait%s%s", updi_nvm_opname(op), s->polls[op],
+        str_plural(s->polls[op]), s->waits[op], str_plural(s->waits[op]),
+        op == UPDI_NVM_OP_NONE? "\n": str_ccprintf(", expected duration %.3f ms\n", s->expect[op]/1000.0));
+}
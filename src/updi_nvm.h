@@ -26,6 +26,7 @@
 #define updi_nvm_h
 
 #include "libavrdude.h"
+#include "updi_state.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,6 +47,10 @@ extern "C" {
   int updi_nvm_write_fuse(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address, uint8_t value);
   int updi_nvm_wait_ready(const PROGRAMMER *pgm, const AVRPART *p);
   int updi_nvm_command(const PROGRAMMER *pgm, const AVRPART *p, uint8_t command);
+  void updi_nvm_started(const PROGRAMMER *pgm, const AVRPART *p, updi_nvm_op op);
+  int updi_nvm_wait_status(const PROGRAMMER *pgm, const AVRPART *p, uint32_t status_addr,
+    uint8_t busy_mask, uint8_t error_mask, int error_bit);
+  void updi_nvm_report(const PROGRAMMER *pgm);
 
 #ifdef __cplusplus
 }
@@ -35,6 +35,7 @@
 #include "libavrdude.h"
 #include "updi_nvm_v5.h"
 #include "updi_state.h"
+#include "updi_nvm.h"
 #include "updi_constants.h"
 #include "updi_readwrite.h"
 
@@ -406,7 +407,7 @@ static int nvm_write_V5(const PROGRAMMER *pgm, const AVRPART *p, uint32_t addres
       return -1;
     }
   } else {
-    if(updi_write_data(pgm, address, buffer, size) < 0) {
+    if(updi_write_data_RSD(pgm, address, buffer, size) < 0) {
       pmsg_error("write data operation failed\n");
       return -1;
     }
@@ -457,26 +458,30 @@ int updi_nvm_wait_ready_V5(const PROGRAMMER *pgm, const AVRPART *p) {
         self.logger.error("Wait NVM ready timed out")
         return False
 */
-  unsigned long start_time;
-  unsigned long current_time;
-  uint8_t status;
-
-  start_time = avr_ustimestamp();
-  do {
-    if(updi_read_byte(pgm, p->nvm_base + UPDI_V5_NVMCTRL_STATUS, &status) >= 0) {
-      if(status & UPDI_V5_NVM_STATUS_WRITE_ERROR_MASK) {
-        pmsg_error("unable to write NVM status, error code %d\n", status >> UPDI_V5_NVM_STATUS_WRITE_ERROR_BIT);
-        return -1;
-      }
-      if(!(status & ((1 << UPDI_V5_NVM_STATUS_EEPROM_BUSY_BIT) | (1 << UPDI_V5_NVM_STATUS_FLASH_BUSY_BIT)))) {
-        return 0;
-      }
-    }
-    current_time = avr_ustimestamp();
-  } while((current_time - start_time) < 10000000);
+  return updi_nvm_wait_status(pgm, p, p->nvm_base + UPDI_V5_NVMCTRL_STATUS,
+    (1 << UPDI_V5_NVM_STATUS_EEPROM_BUSY_BIT) | (1 << UPDI_V5_NVM_STATUS_FLASH_BUSY_BIT),
+    UPDI_V5_NVM_STATUS_WRITE_ERROR_MASK, UPDI_V5_NVM_STATUS_WRITE_ERROR_BIT);
+}
 
-  pmsg_error("wait NVM ready timed out\n");
-  return -1;
+// Kind of NVM operation that a command starts
+static updi_nvm_op nvm_operation(uint8_t command) {
+  switch(command) {
+  case UPDI_V5_NVMCTRL_CTRLA_FLASH_PAGE_WRITE:
+  case UPDI_V5_NVMCTRL_CTRLA_FLASH_PAGE_ERASE_WRITE:
+    return UPDI_NVM_OP_PAGE_WRITE;
+  case UPDI_V5_NVMCTRL_CTRLA_FLASH_PAGE_ERASE:
+    return UPDI_NVM_OP_PAGE_ERASE;
+  case UPDI_V5_NVMCTRL_CTRLA_EEPROM_PAGE_WRITE:
+  case UPDI_V5_NVMCTRL_CTRLA_EEPROM_PAGE_ERASE_WRITE:
+  case UPDI_V5_NVMCTRL_CTRLA_EEPROM_PAGE_ERASE:
+    return UPDI_NVM_OP_EEPROM_WRITE;
+  case UPDI_V5_NVMCTRL_CTRLA_CHIP_ERASE:
+    return UPDI_NVM_OP_CHIP_ERASE;
+  case UPDI_V5_NVMCTRL_CTRLA_EEPROM_ERASE:
+    return UPDI_NVM_OP_EEPROM_ERASE;
+  default:
+    return UPDI_NVM_OP_NONE;
+  }
 }
 
 int updi_nvm_command_V5(const PROGRAMMER *pgm, const AVRPART *p, uint8_t command) {
@@ -492,5 +497,9 @@ int updi_nvm_command_V5(const PROGRAMMER *pgm, const AVRPART *p, uint8_t command
 */
   pmsg_debug("NVMCMD %d executing\n", command);
 
-  return updi_write_byte(pgm, p->nvm_base + UPDI_V5_NVMCTRL_CTRLA, command);
+  if(updi_write_byte(pgm, p->nvm_base + UPDI_V5_NVMCTRL_CTRLA, command) < 0)
+    return -1;
+  updi_nvm_started(pgm, p, nvm_operation(command));
+
+  return 0;
 }
@@ -36,6 +36,7 @@
 #include "updi_constants.h"
 #include "updi_link.h"
 #include "updi_readwrite.h"
+#include "updi_state.h"
 
 int updi_read_cs(const PROGRAMMER *pgm, uint8_t address, uint8_t *value) {
 /*
@@ -165,6 +166,34 @@ int updi_read_data(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uin
   return updi_link_ld_ptr_inc(pgm, buffer, size);
 }
 
+/*
+ * Write size bytes (words if words is set) to address in one RSD burst and
+ * check the UPDI error signature afterwards. On failure resynchronise the
+ * link and switch off RSD for the session, so the caller can retry with
+ * acknowledged writes.
+ */
+static int updi_write_burst(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size, int words) {
+  int blocksize = updi_get_rsd_blocksize(pgm);
+  uint8_t statusb;
+
+  if(updi_link_st_ptr(pgm, address) >= 0 &&
+    (words? updi_link_st_ptr_inc16_RSD(pgm, buffer, size >> 1, blocksize):
+    updi_link_st_ptr_inc_RSD(pgm, buffer, size, blocksize)) >= 0 &&
+    updi_link_ldcs(pgm, UPDI_CS_STATUSB, &statusb) >= 0) {
+
+    if(!(statusb & (7 << UPDI_ASI_STATUSB_PESIG)))
+      return 0;
+    pmsg_debug("UPDI error signature %d after burst write\n", statusb & 7);
+  }
+
+  pmsg_warning("RSD burst write to 0x%06x failed, falling back to acknowledged writes\n", (unsigned) address);
+  updi_set_rsd_mode(pgm, RSD_MODE_OFF);
+  if(updi_link_init(pgm) < 0)
+    pmsg_debug("unable to resynchronise UPDI link\n");
+
+  return -1;
+}
+
 int updi_write_data(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size) {
 /*
     def write_data(self, address, data):
@@ -218,6 +247,18 @@ int updi_write_data(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, ui
   return updi_link_st_ptr_inc(pgm, buffer, size);
 }
 
+/*
+ * As updi_write_data() but in an RSD burst unless switched off; only for
+ * writes into an NVM page buffer, which accepts bytes as fast as they arrive
+ */
+int updi_write_data_RSD(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size) {
+  if(size > 2 && size <= UPDI_MAX_REPEAT_SIZE && updi_get_rsd_mode(pgm) != RSD_MODE_OFF &&
+    updi_write_burst(pgm, address, buffer, size, 0) == 0) {
+    return 0;
+  }
+  return updi_write_data(pgm, address, buffer, size);
+}
+
 int updi_read_data_words(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size) {
 /*
     def read_data_words(self, address, words):
@@ -296,9 +337,16 @@ int updi_write_data_words(const PROGRAMMER *pgm, uint32_t address, uint8_t *buff
     pmsg_debug("invalid length\n");
     return -1;
   }
+  if(updi_get_rsd_mode(pgm) != RSD_MODE_OFF && updi_write_burst(pgm, address, buffer, size, 1) == 0) {
+    return 0;
+  }
   if(updi_link_st_ptr(pgm, address) < 0) {
     pmsg_debug("ST_PTR operation failed\n");
     return -1;
   }
-  return updi_link_st_ptr_inc16_RSD(pgm, buffer, size >> 1, -1);
+  if(updi_link_repeat(pgm, size >> 1) < 0) {
+    pmsg_debug("repeat operation failed\n");
+    return -1;
+  }
+  return updi_link_st_ptr_inc16(pgm, buffer, size >> 1);
 }
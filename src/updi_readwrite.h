@@ -39,6 +39,7 @@ extern "C" {
   int updi_write_byte(const PROGRAMMER *pgm, uint32_t address, uint8_t value);
   int updi_read_data(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
   int updi_write_data(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
+  int updi_write_data_RSD(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
   int updi_read_data_words(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
   int updi_write_data_words(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
 
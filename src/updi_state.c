@@ -54,3 +54,35 @@ updi_rts_mode updi_get_rts_mode(const PROGRAMMER *pgm) {
 void updi_set_rts_mode(const PROGRAMMER *pgm, updi_rts_mode mode) {
   ((updi_state *) (pgm->cookie))->rts_mode = mode;
 }
+
+updi_rsd_mode updi_get_rsd_mode(const PROGRAMMER *pgm) {
+  return ((updi_state *) (pgm->cookie))->rsd_mode;
+}
+
+void updi_set_rsd_mode(const PROGRAMMER *pgm, updi_rsd_mode mode) {
+  ((updi_state *) (pgm->cookie))->rsd_mode = mode;
+}
+
+int updi_get_rsd_blocksize(const PROGRAMMER *pgm) {
+  return ((updi_state *) (pgm->cookie))->rsd_blocksize;
+}
+
+void updi_set_rsd_blocksize(const PROGRAMMER *pgm, int blocksize) {
+  ((updi_state *) (pgm->cookie))->rsd_blocksize = blocksize;
+}
+
+unsigned char *updi_get_echo(const PROGRAMMER *pgm) {
+  return ((updi_state *) (pgm->cookie))->echo;
+}
+
+size_t updi_get_echo_len(const PROGRAMMER *pgm) {
+  return ((updi_state *) (pgm->cookie))->echo_len;
+}
+
+void updi_set_echo_len(const PROGRAMMER *pgm, size_t len) {
+  ((updi_state *) (pgm->cookie))->echo_len = len;
+}
+
+updi_nvm_timing *updi_get_nvm_timing(const PROGRAMMER *pgm) {
+  return &((updi_state *) (pgm->cookie))->nvm_timing;
+}
@@ -40,6 +40,17 @@ typedef enum {
   UPDI_NVM_MODE_V5
 } updi_nvm_mode;
 
+typedef enum {                  // NVM controller operations with their own learned duration
+  UPDI_NVM_OP_NONE,             // Quick commands, eg, page buffer clear or no command
+  UPDI_NVM_OP_CHIP_ERASE,
+  UPDI_NVM_OP_PAGE_ERASE,
+  UPDI_NVM_OP_PAGE_WRITE,
+  UPDI_NVM_OP_EEPROM_ERASE,
+  UPDI_NVM_OP_EEPROM_WRITE,
+  UPDI_NVM_OP_FUSE_WRITE,
+  UPDI_NVM_OP_N
+} updi_nvm_op;
+
 #define SIB_INFO_STRING_LENGTH 32
 #define SIB_INFO_FAMILY_LENGTH 8
 #define SIB_INFO_NVM_LENGTH    3
@@ -47,6 +58,8 @@ typedef enum {
 #define SIB_INFO_PDI_LENGTH    4
 #define SIB_INFO_EXTRA_LENGTH  20
 
+#define UPDI_ECHO_MAX 1024      // Max number of sent bytes whose echo has not yet been read
+
 typedef struct {
   unsigned char sib_string[SIB_INFO_STRING_LENGTH + 1];
   char family_string[SIB_INFO_FAMILY_LENGTH + 1];
@@ -64,11 +77,29 @@ typedef enum {
   RTS_MODE_HIGH
 } updi_rts_mode;
 
+typedef enum {                  // Bulk writes with response signature disabled (RSD)?
+  RSD_MODE_AUTO,                // Yes, with a block size chosen for the serial adapter
+  RSD_MODE_ON,
+  RSD_MODE_OFF                  // No, acknowledge every byte
+} updi_rsd_mode;
+
+typedef struct {
+  updi_nvm_op op;               // NVM operation started last and not yet seen completed
+  uint64_t t_op;                // Time it was started
+  uint32_t expect[UPDI_NVM_OP_N];       // Expected duration of each operation in us
+  long waits[UPDI_NVM_OP_N], polls[UPDI_NVM_OP_N];      // Statistics for verbose output
+} updi_nvm_timing;
+
 typedef struct {
   updi_sib_info sib_info;
   updi_datalink_mode datalink_mode;
   updi_nvm_mode nvm_mode;
   updi_rts_mode rts_mode;
+  updi_rsd_mode rsd_mode;
+  int rsd_blocksize;            // Max bytes per serial write in RSD bursts (0: no limit)
+  unsigned char echo[UPDI_ECHO_MAX];    // Sent bytes the single-wire interface still has to echo
+  size_t echo_len;
+  updi_nvm_timing nvm_timing;
 } updi_state;
 
 #ifdef __cplusplus
@@ -82,6 +113,14 @@ extern "C" {
   void updi_set_nvm_mode(const PROGRAMMER *pgm, updi_nvm_mode mode);
   updi_rts_mode updi_get_rts_mode(const PROGRAMMER *pgm);
   void updi_set_rts_mode(const PROGRAMMER *pgm, updi_rts_mode mode);
+  updi_rsd_mode updi_get_rsd_mode(const PROGRAMMER *pgm);
+  void updi_set_rsd_mode(const PROGRAMMER *pgm, updi_rsd_mode mode);
+  int updi_get_rsd_blocksize(const PROGRAMMER *pgm);
+  void updi_set_rsd_blocksize(const PROGRAMMER *pgm, int blocksize);
+  unsigned char *updi_get_echo(const PROGRAMMER *pgm);
+  size_t updi_get_echo_len(const PROGRAMMER *pgm);
+  void updi_set_echo_len(const PROGRAMMER *pgm, size_t len);
+  updi_nvm_timing *updi_get_nvm_timing(const PROGRAMMER *pgm);
 
 #ifdef __cplusplus
 }
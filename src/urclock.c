@@ -276,6 +276,7 @@ typedef struct {
 
   int32_t storestart;           // Store (ie, unused flash) start address, same as application size
   int32_t storesize;            // Store size
+  int32_t freestart, freeend;   // Unused flash [freestart, freeend) that -x minread does not read
 
   // Metadata for free flash memory to be used for store support
   char filename[254];           // Filename of application, must be max 254 bytes incl nul
@@ -317,6 +318,7 @@ typedef struct {
       nodate,                   // Don't store application filename and no date either
       nostore,                  // Don't store metadata except a flag saying so
       nometadata,               // Don't support metadata at all
+      minread,                  // Only read flash used by application, metadata and bootloader
       noautoreset,              // Don't reset the board after opening the serial port
       delay,                    // Additional delay [ms] after resetting the board, can be negative
       strict;                   // Use strict synchronisation protocol
@@ -537,6 +539,9 @@ static int urclock_flash_readhook(const PROGRAMMER *pgm, const AVRPART *p, const
 
   set_date_filename(pgm, fname);
 
+  // Flash layout on the device may change: -x minread reads all flash from now on
+  ur.freestart = ur.freeend = 0;
+
   // Record extent of metadata, given the command line options (default: max possible)
   ur.mcode = ur.nometadata || ur.nostore? 0xff:
     ur.nodate? 0: ur.nofilename? 1: strlen(ur.filename)+1;
@@ -1060,16 +1065,17 @@ static void set_uP(const PROGRAMMER *pgm, const AVRPART *p, int mcuid, int mcuid
 }
 
 
-// https://en.wikipedia.org/wiki/Jenkins_hash_function
-static uint32_t jenkins_hash(const uint8_t* key, size_t length) {
-  size_t i = 0;
-  uint32_t hash = 0;
+// https://en.wikipedia.org/wiki/Jenkins_hash_function: one byte more
+static uint32_t jenkins_more(uint32_t hash, uint8_t byte) {
+  hash += byte;
+  hash += hash << 10;
+  hash ^= hash >> 6;
 
-  while (i != length) {
-    hash += key[i++];
-    hash += hash << 10;
-    hash ^= hash >> 6;
-  }
+  return hash;
+}
+
+// Finalise a running Jenkins hash without changing it
+static uint32_t jenkins_final(uint32_t hash) {
   hash += hash << 3;
   hash ^= hash >> 11;
   hash += hash << 15;
@@ -1082,16 +1088,11 @@ typedef struct {
   uint32_t h256, hash;
 } Bl_hash;
 
-static int cmpblhash(const void *va, const void *vb) {
-  const Bl_hash *a = va, *b = vb;
-  return a->sz > b->sz? 1: a->sz < b->sz? -1: a->hash > b->hash? 1: a->hash < b->hash? -1: 0;
-}
-
 static void guessblstart(const PROGRAMMER *pgm, const AVRPART *p) {
   if(ur.urprotocol && !(ur.urfeatures & UB_READ_FLASH)) // Cannot read flash
     return;
 
-  Bl_hash blist[] = {
+  static const Bl_hash blist[] = {
     // From https://github.com/arduino/ArduinoCore-avr/tree/master/bootloaders
     { 1024, 0, 0x35445c45, 0x9ef77953 }, // ATmegaBOOT-prod-firmware-2009-11-07.hex
     { 1024, 0, 0x32b1376c, 0xceba80bb }, // ATmegaBOOT.hex
@@ -1139,45 +1140,52 @@ static void guessblstart(const PROGRAMMER *pgm, const AVRPART *p) {
 #include "urclock_hash.h"                // Selected from https://github.com/MCUdude/optiboot_flash
   };
 
-  uint8_t buf[4096], b128[128];
+  /*
+   * All sizes in the table are multiples of 256 bytes. Read flash backwards
+   * from the top in 256-byte blocks and hash it in one sweep, so that the
+   * running hash at the end of each block is that of the candidate size.
+   * The hash of the first block selects the candidates; no need to read
+   * more than the largest of these.
+   */
+  const int nbl = sizeof blist/sizeof*blist;
+  uint8_t b256[256];
+  uint32_t run = 0, h256 = 0;
+  int maxsz = 0;
 
-  qsort(blist, sizeof blist/sizeof*blist, sizeof*blist, cmpblhash);
-  for(int ii, si = 0, sz = 0, bi = 0; si < (int) (sizeof blist/sizeof*blist); si++) {
-    if(blist[si].sz > sz) { // Read in and compare
-      sz = blist[si].sz;
-      if(sz > ur.uP.flashsize/2 || (sz+127)/128*128 > (int) sizeof buf)
+  if(ur.uP.flashsize < 512)
+    return;
+  for(int bi = 0; bi == 0 || bi < maxsz; ) {
+    if(ur_readEF(pgm, p, b256, ur.uP.flashsize-bi-256, 256, 'F') < 0)
+      return;
+    for(int ti = 255; ti >= 0; ti--) // Hash backwards
+      run = jenkins_more(run, b256[ti]);
+    bi += 256;
+
+    uint32_t hash = jenkins_final(run);
+
+    if(bi == 256) {             // Top 256 bytes determine which bootloaders remain possible
+      h256 = hash;
+      for(int ii = 0; ii < nbl; ii++)
+        if(blist[ii].h256 == h256 && blist[ii].sz <= ur.uP.flashsize/2 && !(blist[ii].sz & (ur.uP.pagesize-1)))
+          maxsz = urmax(maxsz, blist[ii].sz);
+      if(!maxsz)
         return;
-      while(bi < sz) {
-       if(ur_readEF(pgm, p, b128, ur.uP.flashsize-bi-128, 128, 'F') < 0)
-         return;
-       for(int ti=127; ti >= 0; ti--) // Read in backwards
-         buf[bi++] = b128[ti];
-      }
+    }
 
-      // Does the hash for the full size match? OK: found a known bootloader
-      uint32_t hash = jenkins_hash(buf, sz);
-      for(ii = 0; ii < (int) (sizeof blist/sizeof*blist); ii++)
-        if(blist[ii].hash == hash && sz == blist[ii].sz && !(sz & (ur.uP.pagesize-1))) {
-          // Page aligned bootloader size matches
-          ur.blstart = ur.uP.flashsize - sz;
-          ur.blend   = ur.uP.flashsize - 1;
-          ur.pfend   = ur.blstart - 1;
-
-          if(blist[ii].ee)
-            ur.bleepromrw = 1;
-          ur.blguessed = 1;
-          return;
-        }
+    // Does the hash for the full size match? OK: found a known bootloader
+    for(int ii = 0; ii < nbl; ii++)
+      if(blist[ii].sz == bi && blist[ii].hash == hash && blist[ii].h256 == h256 &&
+        !(bi & (ur.uP.pagesize-1))) { // Page aligned bootloader size matches
 
-      // Can we exclude the top 256 byte flash from the botloader list?
-      if(sz == 256) {
-        for(ii = 0; ii < (int) (sizeof blist/sizeof*blist); ii++)
-          if(hash == blist[ii].h256)
-            break;
-        if(ii >= (int) (sizeof blist/sizeof*blist))
-          return;
+        ur.blstart = ur.uP.flashsize - bi;
+        ur.blend   = ur.uP.flashsize - 1;
+        ur.pfend   = ur.blstart - 1;
+
+        if(blist[ii].ee)
+          ur.bleepromrw = 1;
+        ur.blguessed = 1;
+        return;
       }
-    }
   }
 }
 
@@ -1502,7 +1510,7 @@ vblvecfound:
   if(havemetadata && ur.pfend >= nmeta(254, flm->size)) {
     int nm = nmeta(1, ur.uP.flashsize); // 6 for date + size of store struct + 1 for mcode byte
     // Showing properties mostly requires examining the bytes below bootloader for metadata
-    if(ur.showall || (ur.showid && *ur.iddesc && *ur.iddesc != 'E') || ur.showapp ||
+    if(ur.minread || ur.showall || (ur.showid && *ur.iddesc && *ur.iddesc != 'E') || ur.showapp ||
       ur.showstore || ur.showmeta || ur.showboot || ur.showversion || ur.showvector ||
       ur.showpart || ur.showdate || ur.showfilename) {
 
@@ -1557,6 +1565,17 @@ vblvecfound:
     }
   }
 
+  // Under -x minread treat the store below the metadata as unused and do not read it
+  if(ur.minread) {
+    if(havemetadata && ur.storesize > 0) {
+      ur.freestart = ur.storestart;
+      ur.freeend = ur.storestart + ur.storesize;
+      pmsg_notice("-x minread: not reading unused flash [0x%04x, 0x%04x]\n", ur.freestart, ur.freeend-1);
+    } else {
+      pmsg_notice("-x minread: no metadata on device, reading all flash\n");
+    }
+  }
+
   // Print and exit when option show... was given
   int first=1;
   int single = !ur.showall && (!!ur.showid + !!ur.showapp + !!ur.showstore + !!ur.showmeta +
@@ -2323,6 +2342,12 @@ static int urclock_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AVR
     for(; addr < n; addr += chunk) {
       chunk = n-addr < page_size? n-addr: page_size;
 
+      // Unused flash is erased flash as far as -x minread is concerned
+      if(mchr == 'F' && (int) addr >= ur.freestart && (int) (addr+chunk) <= ur.freeend) {
+        memset(m->buf+addr, 0xff, chunk);
+        continue;
+      }
+
       if(urclock_paged_rdwr(pgm, p, Cmnd_STK_READ_PAGE, addr, chunk, mchr, NULL) < 0)
         return -3;
       if(urclock_res_check(pgm, __func__, 0, &m->buf[addr], chunk) < 0)
@@ -2461,6 +2486,7 @@ static int urclock_parseextparms(const PROGRAMMER *pgm, LISTID extparms) {
     {"nodate", &ur.nodate, NA,            "Do not store application filename and no date either"},
     {"nostore", &ur.nostore, NA,          "Do not store metadata except a flag saying so"},
     {"nometadata", &ur.nometadata, NA,    "Do not support metadata at all"},
+    {"minread", &ur.minread, NA,          "Do not read unused flash recorded in metadata"},
     {"noautoreset", &ur.nometadata, NA,   "Do not reset the board after opening the serial port"},
     {"delay", &ur.delay, ARG,             "Additional <n> ms delay after reset, can be negative"},
     {"strict", &ur.strict, NA,            "Use strict synchronisation protocol"},
@@ -0,0 +1,245 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Test of the EDBG transport in jtag3.c without hardware, using the exported
+ * jtag3_edbg_*() functions of libavrdude: a stand-in for the USB serial
+ * device models CMSIS-DAP firmware that buffers a given number of 64-byte
+ * packets, acknowledges each command fragment and echoes every command back
+ * as response. The test checks that messages of all sizes round-trip intact
+ * for different buffer counts, that the firmware buffers never overrun and
+ * that a lost or late reply does not desynchronise the next command.
+ */
+
+#include <ac_cfg.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avrdude.h"
+#include "libavrdude.h"
+#include "jtag3.h"
+#include "jtag3_private.h"
+#include "usbdevs.h"
+
+// Global variables referenced by the library
+char *progname = "test-edbg";
+int verbose = -1;
+int quell_progress = 2;
+int ovsigck;
+const char *partdesc = "";
+const char *pgmid = "";
+libavrdude_context *cx;
+
+int avrdude_message2(FILE *fp, int lno, const char *file, const char *func, int msgmode, int msglvl,
+  const char *format, ...) {
+
+  va_list ap;
+
+  if(msglvl > verbose)
+    return 0;
+  va_start(ap, format);
+  vfprintf(stderr, format, ap);
+  va_end(ap);
+
+  return 0;
+}
+
+#define PKT 64                  // CMSIS-DAP packet size of the stand-in
+#define QMAX 32                 // Max replies queued in the stand-in
+
+enum { FAIL_NONE, FAIL_LATE, FAIL_LOST };
+
+static struct {
+  int npackets;                 // Packets the firmware can buffer
+  int outstanding, overrun, turns, sending;
+  unsigned char reply[QMAX][PKT];
+  int head, tail;
+  unsigned char cmd[USBDEV_MAX_XFER_3], rsp[USBDEV_MAX_XFER_3];
+  int cmdlen, rsplen, rspfrag, rspnfrags;
+  int nrecv, fail_at, fail_mode;        // Make the fail_at-th receive fail
+} edbg;
+
+static int edbg_send(const union filedescriptor *fd, const unsigned char *buf, size_t len) {
+  unsigned char *r = edbg.reply[edbg.tail++%QMAX];
+
+  if(len != PKT)
+    return -1;
+  if(!edbg.sending)
+    edbg.turns++;
+  edbg.sending = 1;
+  if(++edbg.outstanding > edbg.npackets)
+    edbg.overrun++;
+
+  memset(r, 0, PKT);
+  switch(buf[0]) {
+  case CMSISDAP_CMD_INFO:
+    r[0] = CMSISDAP_CMD_INFO;
+    if(buf[1] == CMSISDAP_INFO_PACKET_COUNT) {
+      r[1] = 1;
+      r[2] = edbg.npackets;
+    } else if(buf[1] == CMSISDAP_INFO_PACKET_SIZE) {
+      r[1] = 2;                 // Claim 512 bytes, more than the HID report
+      r[3] = 2;
+    }
+    break;
+  case EDBG_VENDOR_AVR_CMD: {
+    int frag = buf[1] >> 4, nfrags = buf[1] & 15, n = buf[2] << 8 | buf[3];
+
+    if(frag == 1)
+      edbg.cmdlen = 0;
+    memcpy(edbg.cmd + edbg.cmdlen, buf + 4, n);
+    edbg.cmdlen += n;
+    r[0] = EDBG_VENDOR_AVR_CMD;
+    r[1] = frag == nfrags;
+    if(frag == nfrags) {        // Response echoes the command
+      memcpy(edbg.rsp, edbg.cmd, edbg.cmdlen);
+      edbg.rsplen = edbg.cmdlen;
+      edbg.rspfrag = 0;
+      edbg.rspnfrags = (edbg.rsplen + PKT - 5)/(PKT - 4);
+    }
+    break;
+  }
+  case EDBG_VENDOR_AVR_RSP: {
+    int off = edbg.rspfrag*(PKT - 4), n = edbg.rsplen - off;
+
+    r[0] = EDBG_VENDOR_AVR_RSP;
+    if(edbg.rspfrag >= edbg.rspnfrags)
+      break;                    // FragmentInfo 0: no response available
+    n = n < PKT - 4? n: PKT - 4;
+    r[1] = (edbg.rspfrag + 1) << 4 | edbg.rspnfrags;
+    r[2] = n >> 8;
+    r[3] = n;
+    memcpy(r + 4, edbg.rsp + off, n);
+    edbg.rspfrag++;
+    break;
+  }
+  }
+
+  return 0;
+}
+
+static int edbg_recv(const union filedescriptor *fd, unsigned char *buf, size_t len) {
+  edbg.sending = 0;
+  if(edbg.head == edbg.tail)    // Nothing pending: time out
+    return -1;
+  if(edbg.nrecv++ == edbg.fail_at) {
+    if(edbg.fail_mode == FAIL_LOST) {
+      edbg.head++;
+      edbg.outstanding--;
+    }
+    return -1;                  // Late replies stay queued
+  }
+  memcpy(buf, edbg.reply[edbg.head++%QMAX], len < PKT? len: PKT);
+  edbg.outstanding--;
+
+  return len;
+}
+
+static struct serial_device edbg_serdev = {
+  .send = edbg_send,
+  .recv = edbg_recv,
+};
+
+static int nfail;
+
+#define check(cond, ...) do { \
+  if(!(cond)) { \
+    fprintf(stderr, __VA_ARGS__); \
+    nfail++; \
+  } \
+} while(0)
+
+// Send a len-byte command and read back its echo; returns number of USB turnarounds or -1
+static int roundtrip(PROGRAMMER *pgm, int len) {
+  unsigned char data[USBDEV_MAX_XFER_3], *msg;
+  int n;
+
+  for(int i = 0; i < len; i++)
+    data[i] = i*13 + len;
+  edbg.turns = 0;
+  if(jtag3_edbg_send(pgm, data, len) < 0)
+    return -1;
+  n = jtag3_edbg_recv_frame(pgm, &msg);
+  if(n < 0)
+    return -1;
+  // Response is TOKEN, dummy, sequence number and data
+  n = n == len + 4 && msg[0] == TOKEN && !memcmp(msg + 4, data, len)? edbg.turns: -1;
+  mmt_free(msg);
+
+  return n;
+}
+
+int main(void) {
+  PROGRAMMER *pgm;
+  int maxlen = 15*(PKT - 4) - 4, turns;
+
+  cx = mmt_malloc(sizeof *cx);
+  pgm = pgm_new();
+  jtag3_setup(pgm);
+  pgm->fd.usb.max_xfer = PKT;
+  serdev = &edbg_serdev;
+  edbg.fail_at = -1;
+
+  // Packet count from DAP_Info; the packet size must stay that of the transport
+  edbg.npackets = 8;
+  jtag3_edbg_info(pgm);
+  check(jtag3_edbg_packets(pgm, 0) == 8, "DAP_Info packet count 8 read as %d\n", jtag3_edbg_packets(pgm, 0));
+  check(pgm->fd.usb.max_xfer == PKT, "packet size changed from %d to %d\n", PKT, pgm->fd.usb.max_xfer);
+
+  // All message sizes for different firmware buffer counts
+  for(int np = 1; np <= 15; np++) {
+    edbg.npackets = jtag3_edbg_packets(pgm, np);
+    for(int len = 1; len <= maxlen; len++) {
+      edbg.overrun = 0;
+      turns = roundtrip(pgm, len);
+      check(turns > 0, "buffer count %d: %d-byte message did not round-trip\n", np, len);
+      check(!edbg.overrun, "buffer count %d: %d-byte message overran the firmware buffer\n", np, len);
+      if(np == 8 && len == 520)
+        check(turns <= 4, "buffer count 8: 520-byte message took %d turnarounds\n", turns);
+    }
+  }
+
+  // A lost or late reply at any point: the next command must still work without pipelining
+  for(int mode = FAIL_LATE; mode <= FAIL_LOST; mode++) {
+    const char *what = mode == FAIL_LATE? "late": "lost";
+
+    for(int at = 0; at < 18; at++) {    // 9 acknowledgements and 9 response fragments
+      edbg.npackets = jtag3_edbg_packets(pgm, 8);
+      edbg.nrecv = 0;
+      edbg.fail_at = at;
+      edbg.fail_mode = mode;
+      check(roundtrip(pgm, 520) < 0, "%s reply %d went unnoticed\n", what, at);
+      edbg.fail_at = -1;
+      check(edbg.head == edbg.tail, "%s reply %d: %d replies left unread\n", what, at, edbg.tail - edbg.head);
+      check(jtag3_edbg_packets(pgm, 0) == 1, "%s reply %d: still pipelining\n", what, at);
+      check(roundtrip(pgm, 200) > 0, "%s reply %d: next command desynchronised\n", what, at);
+    }
+  }
+
+  jtag3_teardown(pgm);
+  pgm_free(pgm);
+  mmt_free(cx);
+
+  if(nfail)
+    fprintf(stderr, "%d EDBG check%s failed\n", nfail, str_plural(nfail));
+
+  return nfail? 1: 0;
+}